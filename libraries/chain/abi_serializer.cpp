@@ -4,6 +4,7 @@
 #include <eosio/chain/asset.hpp>
 #include <eosio/chain/exceptions.hpp>
 #include <fc/io/raw.hpp>
+#include <fc/io/json.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <fc/io/varint.hpp>
 
@@ -74,6 +75,49 @@ namespace eosio { namespace chain {
       );
    }
 
+   // integers that fc::json writes as bare numbers, i.e. those that always fit in 32 bits
+   template <typename T>
+   auto json_write_integer() {
+      static_assert( sizeof(T) <= 4, "wider integers may be quoted by fc::json" );
+      return []( fc::datastream<const char*>& stream, std::string& out ) {
+         T v;
+         fc::raw::unpack( stream, v );
+         out += std::to_string( v );
+      };
+   }
+
+   static void json_write_name( fc::datastream<const char*>& stream, std::string& out ) {
+      name n;
+      fc::raw::unpack( stream, n );
+      out += '"';
+      out += n.to_string(); // only [a-z1-5.], nothing to escape
+      out += '"';
+   }
+
+   static void json_append_key( const string& key, std::string& out ) {
+      out += '"';
+      for( char c : key ) {
+         switch( c ) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+               if( static_cast<unsigned char>(c) < 0x20 ) {
+                  char buf[8];
+                  snprintf( buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c) );
+                  out += buf;
+               } else {
+                  out += c;
+               }
+         }
+      }
+      out += "\":";
+   }
+
    abi_serializer::abi_serializer( const abi_def& abi, const yield_function_t& yield ) {
       configure_built_in_types();
       set_abi(abi, yield);
@@ -87,6 +131,7 @@ namespace eosio { namespace chain {
    void abi_serializer::add_specialized_unpack_pack( const string& name,
                                                      std::pair<abi_serializer::unpack_function, abi_serializer::pack_function> unpack_pack ) {
       built_in_types[name] = std::move( unpack_pack );
+      json_writers.erase( name );
    }
 
    void abi_serializer::configure_built_in_types() {
@@ -130,6 +175,16 @@ namespace eosio { namespace chain {
       built_in_types.emplace("symbol_code",               pack_unpack<symbol_code>());
       built_in_types.emplace("asset",                     pack_unpack<asset>());
       built_in_types.emplace("extended_asset",            pack_unpack<extended_asset>());
+
+      // bool is packed and unpacked as uint8 above, so it is written as a number as well
+      json_writers.emplace("bool",                        json_write_integer<uint8_t>());
+      json_writers.emplace("int8",                        json_write_integer<int8_t>());
+      json_writers.emplace("uint8",                       json_write_integer<uint8_t>());
+      json_writers.emplace("int16",                       json_write_integer<int16_t>());
+      json_writers.emplace("uint16",                      json_write_integer<uint16_t>());
+      json_writers.emplace("int32",                       json_write_integer<int32_t>());
+      json_writers.emplace("uint32",                      json_write_integer<uint32_t>());
+      json_writers.emplace("name",                        json_write_name);
    }
 
    void abi_serializer::set_abi(const abi_def& abi, const yield_function_t& yield) {
@@ -143,6 +198,7 @@ namespace eosio { namespace chain {
       tables.clear();
       error_messages.clear();
       variants.clear();
+      structs_with_repeated_fields.clear();
 
       for( const auto& st : abi.structs )
          structs[st.name] = st;
@@ -177,6 +233,21 @@ namespace eosio { namespace chain {
       EOS_ASSERT( variants.size() == abi.variants.value.size(), duplicate_abi_variant_def_exception, "duplicate variant definition detected" );
 
       validate(ctx);
+
+      // a field name repeated in a struct or its bases leaves one key in the variant built by binary_to_variant
+      for( const auto& st : structs ) {
+         std::set<std::string_view> names;
+         for( const struct_def* s = &st.second; s; ) {
+            bool repeated = false;
+            for( const auto& field : s->fields )
+               repeated |= !names.insert( field.name ).second;
+            if( repeated ) {
+               structs_with_repeated_fields.insert( st.first );
+               break;
+            }
+            s = s->base == type_name() ? nullptr : &get_struct( s->base );
+         }
+      }
    }
 
    void abi_serializer::set_abi(const abi_def& abi, const fc::microseconds& max_serialization_time) {
@@ -442,6 +513,152 @@ namespace eosio { namespace chain {
       return binary_to_variant( type, binary, create_yield_function(max_serialization_time), short_path );
    }
 
+   size_t abi_serializer::_binary_to_json_fields( const std::string_view& type, fc::datastream<const char *>& stream,
+                                                  std::string& out, impl::binary_to_variant_context& ctx )const
+   {
+      auto h = ctx.enter_scope();
+      auto s_itr = structs.find(type);
+      EOS_ASSERT( s_itr != structs.end(), invalid_type_inside_abi, "Unknown type ${type}", ("type",ctx.maybe_shorten(type)) );
+      ctx.hint_struct_type_if_in_array( s_itr );
+      const auto& st = s_itr->second;
+      size_t written = 0;
+      if( st.base != type_name() ) {
+         written = _binary_to_json_fields(resolve_type(st.base), stream, out, ctx);
+      }
+      bool encountered_extension = false;
+      for( uint32_t i = 0; i < st.fields.size(); ++i ) {
+         const auto& field = st.fields[i];
+         bool extension = ends_with(field.type, "$");
+         encountered_extension |= extension;
+         if( !stream.remaining() ) {
+            if( extension ) {
+               continue;
+            }
+            if( encountered_extension ) {
+               EOS_THROW( abi_exception, "Encountered field '${f}' without binary extension designation while processing struct '${p}'",
+                          ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()) );
+            }
+            EOS_THROW( unpack_exception, "Stream unexpectedly ended; unable to unpack field '${f}' of struct '${p}'",
+                       ("f", ctx.maybe_shorten(field.name))("p", ctx.get_path_string()) );
+
+         }
+         auto h1 = ctx.push_to_path( impl::field_path_item{ .parent_struct_itr = s_itr, .field_ordinal = i } );
+         if( written++ ) out += ',';
+         json_append_key( field.name, out );
+         _binary_to_json(resolve_type( extension ? _remove_bin_extension(field.type) : field.type ), stream, out, ctx);
+      }
+      return written;
+   }
+
+   bool abi_serializer::_binary_to_json( const std::string_view& type, fc::datastream<const char *>& stream,
+                                         std::string& out, impl::binary_to_variant_context& ctx )const
+   {
+      auto h = ctx.enter_scope();
+      auto rtype = resolve_type(type);
+      auto ftype = fundamental_type(rtype);
+      auto btype = built_in_types.find(ftype );
+      if( btype != built_in_types.end() ) {
+         try {
+            auto w_itr = json_writers.find(ftype);
+            if( w_itr != json_writers.end() ) {
+               if( is_array(rtype) ) {
+                  fc::unsigned_int size;
+                  fc::raw::unpack(stream, size);
+                  out += '[';
+                  for( decltype(size.value) i = 0; i < size; ++i ) {
+                     if( i ) out += ',';
+                     w_itr->second(stream, out);
+                  }
+                  out += ']';
+               } else if( is_optional(rtype) ) {
+                  char flag;
+                  fc::raw::unpack(stream, flag);
+                  if( !flag ) {
+                     out += "null";
+                     return false;
+                  }
+                  w_itr->second(stream, out);
+               } else {
+                  w_itr->second(stream, out);
+               }
+               return true;
+            }
+            auto v = btype->second.first(stream, is_array(rtype), is_optional(rtype), ctx.get_yield_function());
+            out += fc::json::to_string(v, fc::time_point::maximum());
+            return !v.is_null();
+         } EOS_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack ${class} type '${type}' while processing '${p}'",
+                                   ("class", is_array(rtype) ? "array of built-in" : is_optional(rtype) ? "optional of built-in" : "built-in")
+                                   ("type", impl::limit_size(ftype))("p", ctx.get_path_string()) )
+      }
+      if ( is_array(rtype) ) {
+         ctx.hint_array_type_if_in_array();
+         fc::unsigned_int size;
+         try {
+            fc::raw::unpack(stream, size);
+         } EOS_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack size of array '${p}'", ("p", ctx.get_path_string()) )
+         auto h1 = ctx.push_to_path( impl::array_index_path_item{} );
+         out += '[';
+         for( decltype(size.value) i = 0; i < size; ++i ) {
+            ctx.set_array_index_of_path_back(i);
+            if( i ) out += ',';
+            // same restriction as _binary_to_variant: no null elements
+            EOS_ASSERT( _binary_to_json(ftype, stream, out, ctx), unpack_exception, "Invalid packed array '${p}'", ("p", ctx.get_path_string()) );
+         }
+         out += ']';
+         return true;
+      } else if ( is_optional(rtype) ) {
+         char flag;
+         try {
+            fc::raw::unpack(stream, flag);
+         } EOS_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack presence flag of optional '${p}'", ("p", ctx.get_path_string()) )
+         if( flag )
+            return _binary_to_json(ftype, stream, out, ctx);
+         out += "null";
+         return false;
+      } else {
+         auto v_itr = variants.find(rtype);
+         if( v_itr != variants.end() ) {
+            ctx.hint_variant_type_if_in_array( v_itr );
+            fc::unsigned_int select;
+            try {
+               fc::raw::unpack(stream, select);
+            } EOS_RETHROW_EXCEPTIONS( unpack_exception, "Unable to unpack tag of variant '${p}'", ("p", ctx.get_path_string()) )
+            EOS_ASSERT( (size_t)select < v_itr->second.types.size(), unpack_exception,
+                        "Unpacked invalid tag (${select}) for variant '${p}'", ("select", select.value)("p",ctx.get_path_string()) );
+            auto h1 = ctx.push_to_path( impl::variant_path_item{ .variant_itr = v_itr, .variant_ordinal = static_cast<uint32_t>(select) } );
+            out += '[';
+            out += fc::json::to_string(fc::variant(v_itr->second.types[select]), fc::time_point::maximum());
+            out += ',';
+            _binary_to_json(v_itr->second.types[select], stream, out, ctx);
+            out += ']';
+            return true;
+         }
+      }
+
+      if( structs_with_repeated_fields.find(rtype) != structs_with_repeated_fields.end() ) {
+         // fc::mutable_variant_object keeps the first position and the last value of a repeated key
+         out += fc::json::to_string(_binary_to_variant(rtype, stream, ctx), fc::time_point::maximum());
+         return true;
+      }
+
+      out += '{';
+      const size_t fields = _binary_to_json_fields(rtype, stream, out, ctx);
+      EOS_ASSERT( fields > 0, unpack_exception, "Unable to unpack '${p}' from stream", ("p", ctx.get_path_string()) );
+      out += '}';
+      return true;
+   }
+
+   void abi_serializer::binary_to_json( const std::string_view& type, const bytes& binary, std::string& out, const yield_function_t& yield, bool short_path )const {
+      fc::datastream<const char*> ds( binary.data(), binary.size() );
+      binary_to_json( type, ds, out, yield, short_path );
+   }
+
+   void abi_serializer::binary_to_json( const std::string_view& type, fc::datastream<const char*>& binary, std::string& out, const yield_function_t& yield, bool short_path )const {
+      impl::binary_to_variant_context ctx(*this, yield, type);
+      ctx.short_path = short_path;
+      _binary_to_json(type, binary, out, ctx);
+   }
+
    void abi_serializer::_variant_to_binary( const std::string_view& type, const fc::variant& var, fc::datastream<char *>& ds, impl::variant_to_binary_context& ctx )const
    { try {
       auto h = ctx.enter_scope();
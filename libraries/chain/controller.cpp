@@ -14,7 +14,7 @@
 #include <eosio/chain/contract_table_objects.hpp>
 #include <eosio/chain/generated_transaction_object.hpp>
 #include <eosio/chain/transaction_object.hpp>
-#include <eosio/chain/reversible_block_object.hpp>
+#include <eosio/chain/reversible_block_log.hpp>
 #include <eosio/chain/genesis_intrinsics.hpp>
 #include <eosio/chain/whitelisted_intrinsics.hpp>
 #include <eosio/chain/database_header_object.hpp>
@@ -32,6 +32,8 @@
 #include <fc/scoped_exit.hpp>
 #include <fc/variant_object.hpp>
 
+#include <future>
+#include <map>
 #include <new>
 
 namespace eosio { namespace chain {
@@ -122,7 +124,7 @@ struct building_block {
    size_t                                _num_new_protocol_features_that_have_activated = 0;
    vector<transaction_metadata_ptr>      _pending_trx_metas;
    vector<transaction_receipt>           _pending_trx_receipts;
-   vector<action_receipt>                _actions;
+   merkle_accumulator                    _action_merkle;
    optional<checksum256_type>            _transaction_mroot;
 };
 
@@ -226,7 +228,7 @@ struct controller_impl {
    reset_new_handler              rnh; // placed here to allow for this to be set before constructing the other fields
    controller&                    self;
    chainbase::database            db;
-   chainbase::database            reversible_blocks; ///< a special database to persist blocks that have successfully been applied but are still reversible
+   reversible_block_log           reversible_blocks; ///< persists blocks that have successfully been applied but are still reversible
    block_log                      blog;
    optional<pending_state>        pending;
    block_state_ptr                head;
@@ -244,6 +246,9 @@ struct controller_impl {
    bool                           trusted_producer_light_validation = false;
    uint32_t                       snapshot_head_block = 0;
    named_thread_pool              thread_pool;
+   /// block states being created on the thread pool that have not been pushed yet, so that the next block can be
+   /// validated against them before they reach the fork database
+   std::map<block_id_type, std::shared_future<block_state_ptr>> pending_block_states;
    platform_timer                 timer;
 #if defined(EOSIO_EOS_VM_RUNTIME_ENABLED) || defined(EOSIO_EOS_VM_JIT_RUNTIME_ENABLED)
    vm::wasm_allocator                 wasm_alloc;
@@ -261,10 +266,7 @@ struct controller_impl {
          prev = fork_db.root();
       }
 
-      if( const auto* b = reversible_blocks.find<reversible_block_object,by_num>(head->block_num) )
-      {
-         reversible_blocks.remove( *b );
-      }
+      reversible_blocks.remove_from( head->block_num );
 
       if ( read_mode == db_read_mode::SPECULATIVE ) {
          EOS_ASSERT( head->block, block_validate_exception, "attempting to pop a block that was sparsely loaded from a snapshot");
@@ -302,9 +304,7 @@ struct controller_impl {
     db( cfg.state_dir,
         cfg.read_only ? database::read_only : database::read_write,
         cfg.state_size, false, cfg.db_map_mode, cfg.db_hugepage_paths ),
-    reversible_blocks( cfg.blocks_dir/config::reversible_blocks_dir_name,
-        cfg.read_only ? database::read_only : database::read_write,
-        cfg.reversible_cache_size, false, cfg.db_map_mode, cfg.db_hugepage_paths ),
+    reversible_blocks( cfg.blocks_dir/config::reversible_blocks_dir_name ),
     blog( cfg.blocks_dir ),
     fork_db( cfg.state_dir ),
     wasmif( cfg.wasm_runtime, cfg.eosvmoc_tierup, db, cfg.state_dir, cfg.eosvmoc_config ),
@@ -407,8 +407,6 @@ struct controller_impl {
 
       const auto branch = fork_db.fetch_branch( fork_head->id, fork_head->dpos_irreversible_blocknum );
       try {
-         const auto& rbi = reversible_blocks.get_index<reversible_block_index,by_num>();
-
          for( auto bitr = branch.rbegin(); bitr != branch.rend(); ++bitr ) {
             if( read_mode == db_read_mode::IRREVERSIBLE ) {
                apply_block( *bitr, controller::block_status::complete, trx_meta_cache_lookup{} );
@@ -423,11 +421,7 @@ struct controller_impl {
 
             blog.append( (*bitr)->block );
 
-            auto rbitr = rbi.begin();
-            while( rbitr != rbi.end() && rbitr->blocknum <= (*bitr)->block_num ) {
-               reversible_blocks.remove( *rbitr );
-               rbitr = rbi.begin();
-            }
+            reversible_blocks.remove_through( (*bitr)->block_num );
          }
       } catch( fc::exception& ) {
          if( root_id != fork_db.root()->id ) {
@@ -518,9 +512,9 @@ struct controller_impl {
 
       if( !except_ptr && !shutdown() ) {
          int rev = 0;
-         while( auto obj = reversible_blocks.find<reversible_block_object,by_num>(head->block_num+1) ) {
+         while( auto b = reversible_blocks.read_block( head->block_num+1 ) ) {
             ++rev;
-            replay_push_block( obj->get_block(), controller::block_status::validated );
+            replay_push_block( b, controller::block_status::validated );
          }
          ilog( "${n} reversible blocks replayed", ("n",rev) );
       }
@@ -677,31 +671,24 @@ struct controller_impl {
 
       protocol_features.init( db );
 
-      const auto& rbi = reversible_blocks.get_index<reversible_block_index,by_num>();
       auto last_block_num = lib_num;
 
       if( read_mode == db_read_mode::IRREVERSIBLE ) {
          // ensure there are no reversible blocks
-         auto itr = rbi.begin();
-         if( itr != rbi.end() ) {
+         if( !reversible_blocks.empty() ) {
             wlog( "read_mode has changed to irreversible: erasing reversible blocks" );
          }
-         for( ; itr != rbi.end(); itr = rbi.begin() )
-            reversible_blocks.remove( *itr );
+         reversible_blocks.clear();
       } else {
-         auto itr = rbi.begin();
-         for( ; itr != rbi.end() && itr->blocknum <= lib_num; itr = rbi.begin() )
-            reversible_blocks.remove( *itr );
+         reversible_blocks.remove_through( lib_num );
 
-         EOS_ASSERT( itr == rbi.end() || itr->blocknum == lib_num + 1, reversible_blocks_exception,
+         EOS_ASSERT( reversible_blocks.empty() || reversible_blocks.first_block_num() == lib_num + 1, reversible_blocks_exception,
                      "gap exists between last irreversible block (${lib}) and first reversible block (${first_reversible_block_num})",
-                     ("lib", lib_num)("first_reversible_block_num", itr->blocknum)
+                     ("lib", lib_num)("first_reversible_block_num", reversible_blocks.first_block_num())
          );
 
-         auto ritr = rbi.rbegin();
-
-         if( ritr != rbi.rend() ) {
-            last_block_num = ritr->blocknum;
+         if( !reversible_blocks.empty() ) {
+            last_block_num = reversible_blocks.last_block_num();
          }
 
          EOS_ASSERT( head->block_num <= last_block_num, reversible_blocks_exception,
@@ -711,23 +698,22 @@ struct controller_impl {
 
          auto pending_head = fork_db.pending_head();
 
-         if( ritr != rbi.rend()
+         if( !reversible_blocks.empty()
              && lib_num < pending_head->block_num
              && pending_head->block_num <= last_block_num
          ) {
-            auto rbitr = rbi.find( pending_head->block_num );
-            EOS_ASSERT( rbitr != rbi.end(), reversible_blocks_exception, "pending head block not found in reversible blocks");
-            auto rev_id = rbitr->get_block_id();
-            EOS_ASSERT( rev_id == pending_head->id,
+            auto rev_id = reversible_blocks.read_block_id( pending_head->block_num );
+            EOS_ASSERT( rev_id, reversible_blocks_exception, "pending head block not found in reversible blocks");
+            EOS_ASSERT( *rev_id == pending_head->id,
                         reversible_blocks_exception,
                         "mismatch in block id of pending head block ${num} in reversible blocks database: "
                         "expected: ${expected}, actual: ${actual}",
-                        ("num", pending_head->block_num)("expected", pending_head->id)("actual", rev_id)
+                        ("num", pending_head->block_num)("expected", pending_head->id)("actual", *rev_id)
             );
-         } else if( ritr != rbi.rend() && last_block_num < pending_head->block_num ) {
+         } else if( !reversible_blocks.empty() && last_block_num < pending_head->block_num ) {
             const auto b = fork_db.search_on_branch( pending_head->id, last_block_num );
             FC_ASSERT( b, "unexpected violation of invariants" );
-            auto rev_id = ritr->get_block_id();
+            auto rev_id = *reversible_blocks.read_block_id( last_block_num );
             EOS_ASSERT( rev_id == b->id,
                         reversible_blocks_exception,
                         "mismatch in block id of last block (${num}) in reversible blocks database: "
@@ -766,8 +752,6 @@ struct controller_impl {
    }
 
    void add_indices() {
-      reversible_blocks.add_index<reversible_block_index>();
-
       controller_index_set::add_indices(db);
       contract_database_index_set::add_indices(db);
 
@@ -1089,17 +1073,17 @@ struct controller_impl {
       auto& bb = pending->_block_stage.get<building_block>();
       auto orig_block_transactions_size = bb._pending_trx_receipts.size();
       auto orig_state_transactions_size = bb._pending_trx_metas.size();
-      auto orig_state_actions_size      = bb._actions.size();
+      auto orig_action_merkle           = bb._action_merkle;
 
       std::function<void()> callback = [this,
                                         orig_block_transactions_size,
                                         orig_state_transactions_size,
-                                        orig_state_actions_size]()
+                                        orig_action_merkle]()
       {
          auto& bb = pending->_block_stage.get<building_block>();
          bb._pending_trx_receipts.resize(orig_block_transactions_size);
          bb._pending_trx_metas.resize(orig_state_transactions_size);
-         bb._actions.resize(orig_state_actions_size);
+         bb._action_merkle = orig_action_merkle;
       };
 
       return fc::make_scoped_exit( std::move(callback) );
@@ -1143,7 +1127,7 @@ struct controller_impl {
          auto restore = make_block_restore_point();
          trace->receipt = push_receipt( gtrx.trx_id, transaction_receipt::soft_fail,
                                         trx_context.billed_cpu_time_us, trace->net_usage );
-         fc::move_append( pending->_block_stage.get<building_block>()._actions, move(trx_context.executed) );
+         append_action_receipts( trx_context.executed );
 
          trx_context.squash();
          restore.cancel();
@@ -1285,7 +1269,7 @@ struct controller_impl {
                                         trx_context.billed_cpu_time_us,
                                         trace->net_usage );
 
-         fc::move_append( pending->_block_stage.get<building_block>()._actions, move(trx_context.executed) );
+         append_action_receipts( trx_context.executed );
 
          trace->account_ram_delta = account_delta( gtrx.payer, trx_removal_ram_delta );
 
@@ -1475,7 +1459,7 @@ struct controller_impl {
                trace->receipt = r;
             }
 
-            fc::move_append(pending->_block_stage.get<building_block>()._actions, move(trx_context.executed));
+            append_action_receipts( trx_context.executed );
 
             // call the accept signal but only once for this transaction
             if (!trx->accepted) {
@@ -1746,10 +1730,7 @@ struct controller_impl {
          }
 
          if( !replay_head_time && read_mode != db_read_mode::IRREVERSIBLE ) {
-            reversible_blocks.create<reversible_block_object>( [&]( auto& ubo ) {
-               ubo.blocknum = bsp->block_num;
-               ubo.set_block( bsp->block );
-            });
+            reversible_blocks.append( bsp->block );
          }
 
          emit( self.accepted_block, bsp );
@@ -1963,23 +1944,58 @@ struct controller_impl {
 
       auto id = b->id();
 
+      auto share = []( std::shared_future<block_state_ptr> f ) {
+         return std::async( std::launch::deferred, [f]() { return f.get(); } );
+      };
+
+      auto pending_itr = pending_block_states.find( id );
+      if( pending_itr != pending_block_states.end() )
+         return share( pending_itr->second );
+
       // no reason for a block_state if fork_db already knows about block
       auto existing = fork_db.get_block( id );
       EOS_ASSERT( !existing, fork_database_exception, "we already know about this block: ${id}", ("id", id) );
 
+      // the previous block may itself still be waiting to be pushed, in which case this block is validated against it
       auto prev = fork_db.get_block_header( b->previous );
-      EOS_ASSERT( prev, unlinkable_block_exception,
-                  "unlinkable block ${id}", ("id", id)("previous", b->previous) );
+      std::shared_future<block_state_ptr> prev_future;
+      if( !prev ) {
+         auto prev_itr = pending_block_states.find( b->previous );
+         EOS_ASSERT( prev_itr != pending_block_states.end(), unlinkable_block_exception,
+                     "unlinkable block ${id}", ("id", id)("previous", b->previous) );
+         prev_future = prev_itr->second;
+      }
+
+      // Blocks queued behind another block are being synced, so also recover their transaction signatures now rather
+      // than when they are applied. Otherwise leave it to apply_block, which can reuse already recovered transactions.
+      vector<recover_keys_future> trx_keys;
+      if( prev_future.valid() ) {
+         trx_keys.reserve( b->transactions.size() );
+         for( const auto& receipt : b->transactions ) {
+            if( receipt.trx.contains<packed_transaction>() ) {
+               auto ptrx = std::make_shared<packed_transaction>( receipt.trx.get<packed_transaction>() );
+               trx_keys.emplace_back( transaction_metadata::start_recover_keys(
+                     std::move( ptrx ), thread_pool.get_executor(), chain_id, microseconds::maximum() ) );
+            }
+         }
+      }
 
-      return async_thread_pool( thread_pool.get_executor(), [b, prev, control=this]() {
+      auto bsf = async_thread_pool( thread_pool.get_executor(),
+                                    [b, prev, prev_future, trx_keys{std::move(trx_keys)}, control=this]() mutable {
          const bool skip_validate_signee = false;
 
          auto trx_mroot = calculate_trx_merkle( b->transactions );
          EOS_ASSERT( b->transaction_mroot == trx_mroot, block_validate_exception,
                      "invalid block transaction merkle root ${b} != ${c}", ("b", b->transaction_mroot)("c", trx_mroot) );
 
-         return std::make_shared<block_state>(
-                        *prev,
+         // Blocking here relies on the thread pool dequeuing tasks in the order they were posted (a single asio
+         // io_context queue): the task behind prev_future and the recover-keys tasks behind trx_keys were posted
+         // before this one, so by the time this task runs they are already running on another thread or done.
+         // Dispatching from a pool that does not preserve post order (e.g. work stealing) could deadlock here.
+         block_header_state_ptr prev_bhs = prev ? prev : prev_future.get();
+
+         auto bsp = std::make_shared<block_state>(
+                        *prev_bhs,
                         move( b ),
                         control->protocol_features.get_protocol_feature_set(),
                         [control]( block_timestamp_type timestamp,
@@ -1988,7 +2004,19 @@ struct controller_impl {
                         { control->check_protocol_features( timestamp, cur_features, new_features ); },
                         skip_validate_signee
          );
-      } );
+
+         if( !trx_keys.empty() ) {
+            vector<transaction_metadata_ptr> trx_metas;
+            trx_metas.reserve( trx_keys.size() );
+            for( auto& f : trx_keys )
+               trx_metas.emplace_back( f.get() );
+            bsp->set_trxs_metas( std::move( trx_metas ), true );
+         }
+         return bsp;
+      } ).share();
+
+      pending_block_states.emplace( id, bsf );
+      return share( bsf );
    }
 
    void push_block( std::future<block_state_ptr>& block_state_future,
@@ -2000,9 +2028,28 @@ struct controller_impl {
       auto reset_prod_light_validation = fc::make_scoped_exit([old_value=trusted_producer_light_validation, this]() {
          trusted_producer_light_validation = old_value;
       });
+      // forget block states that can no longer be pushed onto the current head, and failed ones so that a retry
+      // validates the block again
+      auto prune_pending_block_states = fc::make_scoped_exit([this]() {
+         for( auto itr = pending_block_states.begin(); itr != pending_block_states.end(); ) {
+            bool failed = false;
+            if( itr->second.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready ) {
+               try {
+                  itr->second.get();
+               } catch( ... ) {
+                  failed = true;
+               }
+            }
+            if( failed || block_header::num_from_id( itr->first ) <= head->block_num )
+               itr = pending_block_states.erase( itr );
+            else
+               ++itr;
+         }
+      });
       try {
          block_state_ptr bsp = block_state_future.get();
          const auto& b = bsp->block;
+         pending_block_states.erase( bsp->id );
 
          emit( self.pre_accepted_block, b );
 
@@ -2025,7 +2072,6 @@ struct controller_impl {
 
    void replay_push_block( const signed_block_ptr& b, controller::block_status s ) {
       self.validate_db_available_size();
-      self.validate_reversible_available_size();
 
       EOS_ASSERT(!pending, block_validate_exception, "it is not valid to push a block when there is a pending block");
 
@@ -2158,14 +2204,23 @@ struct controller_impl {
       return applied_trxs;
    }
 
-   checksum256_type calculate_action_merkle() {
+   /// folds the receipts of a successfully applied transaction into the pending block's action merkle
+   void append_action_receipts( const vector<action_receipt>& executed ) {
+      auto& action_merkle = pending->_block_stage.get<building_block>()._action_merkle;
+      for( const auto& d : calculate_action_receipt_digests( executed ) )
+         action_merkle.append( d );
+   }
+
+   static vector<digest_type> calculate_action_receipt_digests( const vector<action_receipt>& actions ) {
       vector<digest_type> action_digests;
-      const auto& actions = pending->_block_stage.get<building_block>()._actions;
       action_digests.reserve( actions.size() );
       for( const auto& a : actions )
          action_digests.emplace_back( a.digest() );
+      return action_digests;
+   }
 
-      return merkle( move(action_digests) );
+   checksum256_type calculate_action_merkle() {
+      return pending->_block_stage.get<building_block>()._action_merkle.get_root();
    }
 
    static checksum256_type calculate_trx_merkle( const vector<transaction_receipt>& trxs ) {
@@ -2654,7 +2709,6 @@ block_state_ptr controller::finalize_block( const signer_callback_type& signer_c
 
 void controller::commit_block() {
    validate_db_available_size();
-   validate_reversible_available_size();
    my->commit_block(true);
 }
 
@@ -2674,7 +2728,6 @@ void controller::push_block( std::future<block_state_ptr>& block_state_future,
                              const forked_branch_callback& forked_branch_cb, const trx_meta_cache_lookup& trx_lookup )
 {
    validate_db_available_size();
-   validate_reversible_available_size();
    my->push_block( block_state_future, forked_branch_cb, trx_lookup );
 }
 
@@ -2869,10 +2922,9 @@ block_state_ptr controller::fetch_block_state_by_id( block_id_type id )const {
 }
 
 block_state_ptr controller::fetch_block_state_by_number( uint32_t block_num )const  { try {
-   const auto& rev_blocks = my->reversible_blocks.get_index<reversible_block_index,by_num>();
-   auto objitr = rev_blocks.find(block_num);
+   auto rev_id = my->reversible_blocks.read_block_id( block_num );
 
-   if( objitr == rev_blocks.end() ) {
+   if( !rev_id ) {
       if( my->read_mode == db_read_mode::IRREVERSIBLE ) {
          return my->fork_db.search_on_branch( my->fork_db.pending_head()->id, block_num );
       } else {
@@ -2880,7 +2932,7 @@ block_state_ptr controller::fetch_block_state_by_number( uint32_t block_num )con
       }
    }
 
-   return my->fork_db.get_block( objitr->get_block_id() );
+   return my->fork_db.get_block( *rev_id );
 } FC_CAPTURE_AND_RETHROW( (block_num) ) }
 
 block_id_type controller::get_block_id_for_num( uint32_t block_num )const { try {
@@ -2895,10 +2947,9 @@ block_id_type controller::get_block_id_for_num( uint32_t block_num )const { try
 
    if( !find_in_blog ) {
       if( my->read_mode != db_read_mode::IRREVERSIBLE ) {
-         const auto& rev_blocks = my->reversible_blocks.get_index<reversible_block_index,by_num>();
-         auto objitr = rev_blocks.find(block_num);
-         if( objitr != rev_blocks.end() ) {
-            return objitr->get_block_id();
+         auto rev_id = my->reversible_blocks.read_block_id( block_num );
+         if( rev_id ) {
+            return *rev_id;
          }
       } else {
          auto bsp = my->fork_db.search_on_branch( my->fork_db.pending_head()->id, block_num );
@@ -3072,6 +3123,10 @@ db_read_mode controller::get_read_mode()const {
    return my->read_mode;
 }
 
+bool controller::is_state_in_private_memory()const {
+   return my->conf.db_map_mode != pinnable_mapped_file::map_mode::mapped && my->conf.db_hugepage_paths.empty();
+}
+
 validation_mode controller::get_validation_mode()const {
    return my->conf.block_validation_mode;
 }
@@ -3164,12 +3219,6 @@ void controller::validate_db_available_size() const {
    EOS_ASSERT(free >= guard, database_guard_exception, "database free: ${f}, guard size: ${g}", ("f", free)("g",guard));
 }
 
-void controller::validate_reversible_available_size() const {
-   const auto free = my->reversible_blocks.get_segment_manager()->get_free_memory();
-   const auto guard = my->conf.reversible_guard_size;
-   EOS_ASSERT(free >= guard, reversible_guard_exception, "reversible free: ${f}, guard size: ${g}", ("f", free)("g",guard));
-}
-
 bool controller::is_protocol_feature_activated( const digest_type& feature_digest )const {
    if( my->pending )
       return my->pending->is_protocol_feature_activated( feature_digest );
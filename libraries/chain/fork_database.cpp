@@ -8,7 +8,9 @@
 #include <boost/multi_index/global_fun.hpp>
 #include <boost/multi_index/composite_key.hpp>
 #include <fc/io/fstream.hpp>
-#include <fstream>
+#include <fc/io/cfile.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
 
 namespace eosio { namespace chain {
    using boost::multi_index_container;
@@ -17,7 +19,7 @@ namespace eosio { namespace chain {
    const uint32_t fork_database::magic_number = 0x30510FDB;
 
    const uint32_t fork_database::min_supported_version = 1;
-   const uint32_t fork_database::max_supported_version = 1;
+   const uint32_t fork_database::max_supported_version = 2;
 
    // work around block_state::is_valid being private
    inline bool block_state_is_valid( const block_state& bs ) {
@@ -27,6 +29,8 @@ namespace eosio { namespace chain {
    /**
     * History:
     * Version 1: initial version of the new refactored fork database portable format
+    * Version 2: fork_db.dat, written in full on close, replaced by the fork_db.log journal which is appended to
+    *            as the fork database changes and compacted as the root advances
     */
 
    struct by_block_id;
@@ -59,6 +63,27 @@ namespace eosio { namespace chain {
                > std::tie( rhs.dpos_irreversible_blocknum, rhs.block_num );
    }
 
+   namespace {
+      /// versions of the fork database format below this one are the single snapshot fork_db.dat written on close
+      constexpr uint32_t first_journal_version = 2;
+
+      constexpr uint64_t journal_header_size = sizeof(uint32_t) + sizeof(uint32_t); // magic number, version
+      constexpr uint64_t record_prefix_size  = sizeof(uint8_t) + sizeof(uint32_t);  // operation, payload size
+
+      /// journal is only compacted once it holds at least this many records
+      constexpr uint64_t min_records_to_compact = 64;
+
+      enum class journal_op : uint8_t {
+         reset,                 ///< packed block_header_state of the new root; drops everything before it
+         add,                   ///< packed block_state
+         remove,                ///< block id
+         mark_valid,            ///< block id
+         advance_root,          ///< block id
+         rollback_head_to_root, ///< no payload
+         set_head               ///< block id
+      };
+   }
+
    struct fork_database_impl {
       fork_database_impl( fork_database& self, const fc::path& data_dir )
       :self(self)
@@ -70,12 +95,32 @@ namespace eosio { namespace chain {
       block_state_ptr       root; // Only uses the block_header_state portion
       block_state_ptr       head;
       fc::path              datadir;
+      fc::cfile             journal;
+      uint64_t              journal_records = 0;
 
-      void add( const block_state_ptr& n,
+      bool add( const block_state_ptr& n,
                 bool ignore_duplicate, bool validate,
                 const std::function<void( block_timestamp_type,
                                           const flat_set<digest_type>&,
                                           const vector<digest_type>& )>& validator );
+      void reset( const block_header_state& root_bhs );
+      void rollback_head_to_root();
+      void advance_root( const block_id_type& id );
+      void remove( const block_id_type& id );
+      void mark_valid( const block_state_ptr& h );
+      void set_head( const block_id_type& id );
+
+      void read_legacy_file( const fc::path& fork_db_dat,
+                             const std::function<void( block_timestamp_type,
+                                                       const flat_set<digest_type>&,
+                                                       const vector<digest_type>& )>& validator );
+      void replay_journal( const fc::path& journal_path,
+                           const std::function<void( block_timestamp_type,
+                                                     const flat_set<digest_type>&,
+                                                     const vector<digest_type>& )>& validator );
+      void append_journal( journal_op op, const vector<char>& payload = vector<char>() );
+      void compact_journal();
+      void compact_journal_if_needed();
    };
 
 
@@ -91,136 +136,261 @@ namespace eosio { namespace chain {
       if (!fc::is_directory(my->datadir))
          fc::create_directories(my->datadir);
 
-      auto fork_db_dat = my->datadir / config::forkdb_filename;
-      if( fc::exists( fork_db_dat ) ) {
-         try {
-            string content;
-            fc::read_file_contents( fork_db_dat, content );
-
-            fc::datastream<const char*> ds( content.data(), content.size() );
-
-            // validate totem
-            uint32_t totem = 0;
-            fc::raw::unpack( ds, totem );
-            EOS_ASSERT( totem == magic_number, fork_database_exception,
-                        "Fork database file '${filename}' has unexpected magic number: ${actual_totem}. Expected ${expected_totem}",
-                        ("filename", fork_db_dat.generic_string())
-                        ("actual_totem", totem)
-                        ("expected_totem", magic_number)
-            );
-
-            // validate version
-            uint32_t version = 0;
-            fc::raw::unpack( ds, version );
-            EOS_ASSERT( version >= min_supported_version && version <= max_supported_version,
-                        fork_database_exception,
-                       "Unsupported version of fork database file '${filename}'. "
-                       "Fork database version is ${version} while code supports version(s) [${min},${max}]",
-                       ("filename", fork_db_dat.generic_string())
-                       ("version", version)
-                       ("min", min_supported_version)
-                       ("max", max_supported_version)
-            );
-
-            block_header_state bhs;
-            fc::raw::unpack( ds, bhs );
-            reset( bhs );
-
-            unsigned_int size; fc::raw::unpack( ds, size );
-            for( uint32_t i = 0, n = size.value; i < n; ++i ) {
-               block_state s;
-               fc::raw::unpack( ds, s );
-               // do not populate transaction_metadatas, they will be created as needed in apply_block with appropriate key recovery
-               s.header_exts = s.block->validate_and_extract_header_extensions();
-               my->add( std::make_shared<block_state>( move( s ) ), false, true, validator );
-            }
-            block_id_type head_id;
-            fc::raw::unpack( ds, head_id );
-
-            if( my->root->id == head_id ) {
-               my->head = my->root;
-            } else {
-               my->head = get_block( head_id );
-               EOS_ASSERT( my->head, fork_database_exception,
-                           "could not find head while reconstructing fork database from file; '${filename}' is likely corrupted",
-                           ("filename", fork_db_dat.generic_string()) );
-            }
+      auto fork_db_dat  = my->datadir / config::forkdb_filename;
+      auto journal_path = my->datadir / config::forkdb_journal_filename;
 
-            auto candidate = my->index.get<by_lib_block_num>().begin();
-            if( candidate == my->index.get<by_lib_block_num>().end() || !(*candidate)->is_valid() ) {
-               EOS_ASSERT( my->head->id == my->root->id, fork_database_exception,
-                           "head not set to root despite no better option available; '${filename}' is likely corrupted",
-                           ("filename", fork_db_dat.generic_string()) );
-            } else {
-               EOS_ASSERT( !first_preferred( **candidate, *my->head ), fork_database_exception,
-                           "head not set to best available option available; '${filename}' is likely corrupted",
-                           ("filename", fork_db_dat.generic_string()) );
-            }
-         } FC_CAPTURE_AND_RETHROW( (fork_db_dat) )
+      // A fork_db.dat is only left behind by a clean shutdown of a version that did not keep a journal,
+      // so when present it is more recent than any journal found next to it.
+      if( fc::exists( fork_db_dat ) ) {
+         my->read_legacy_file( fork_db_dat, validator );
+      } else if( fc::exists( journal_path ) ) {
+         my->replay_journal( journal_path, validator );
+      }
 
+      if( fc::exists( fork_db_dat ) || !fc::exists( journal_path ) ) {
+         my->compact_journal();
          fc::remove( fork_db_dat );
+      } else {
+         my->journal.set_file_path( journal_path );
+         my->journal.open( "rb+" );
+         my->journal.seek_end( 0 );
+         my->compact_journal_if_needed();
       }
    }
 
-   void fork_database::close() {
-      auto fork_db_dat = my->datadir / config::forkdb_filename;
+   void fork_database_impl::read_legacy_file( const fc::path& fork_db_dat,
+                                              const std::function<void( block_timestamp_type,
+                                                                        const flat_set<digest_type>&,
+                                                                        const vector<digest_type>& )>& validator )
+   {
+      try {
+         string content;
+         fc::read_file_contents( fork_db_dat, content );
+
+         fc::datastream<const char*> ds( content.data(), content.size() );
+
+         // validate totem
+         uint32_t totem = 0;
+         fc::raw::unpack( ds, totem );
+         EOS_ASSERT( totem == fork_database::magic_number, fork_database_exception,
+                     "Fork database file '${filename}' has unexpected magic number: ${actual_totem}. Expected ${expected_totem}",
+                     ("filename", fork_db_dat.generic_string())
+                     ("actual_totem", totem)
+                     ("expected_totem", fork_database::magic_number)
+         );
 
-      if( !my->root ) {
-         if( my->index.size() > 0 ) {
-            elog( "fork_database is in a bad state when closing; not writing out '${filename}'",
-                  ("filename", fork_db_dat.generic_string()) );
+         // validate version
+         uint32_t version = 0;
+         fc::raw::unpack( ds, version );
+         EOS_ASSERT( version >= fork_database::min_supported_version && version < first_journal_version,
+                     fork_database_exception,
+                    "Unsupported version of fork database file '${filename}'. "
+                    "Fork database version is ${version} while code supports version(s) [${min},${max}]",
+                    ("filename", fork_db_dat.generic_string())
+                    ("version", version)
+                    ("min", fork_database::min_supported_version)
+                    ("max", first_journal_version - 1)
+         );
+
+         block_header_state bhs;
+         fc::raw::unpack( ds, bhs );
+         reset( bhs );
+
+         unsigned_int size; fc::raw::unpack( ds, size );
+         for( uint32_t i = 0, n = size.value; i < n; ++i ) {
+            block_state s;
+            fc::raw::unpack( ds, s );
+            // do not populate transaction_metadatas, they will be created as needed in apply_block with appropriate key recovery
+            s.header_exts = s.block->validate_and_extract_header_extensions();
+            add( std::make_shared<block_state>( move( s ) ), false, true, validator );
          }
-         return;
-      }
+         block_id_type head_id;
+         fc::raw::unpack( ds, head_id );
+         set_head( head_id );
+
+         auto candidate = index.get<by_lib_block_num>().begin();
+         if( candidate == index.get<by_lib_block_num>().end() || !(*candidate)->is_valid() ) {
+            EOS_ASSERT( head->id == root->id, fork_database_exception,
+                        "head not set to root despite no better option available; '${filename}' is likely corrupted",
+                        ("filename", fork_db_dat.generic_string()) );
+         } else {
+            EOS_ASSERT( !first_preferred( **candidate, *head ), fork_database_exception,
+                        "head not set to best available option available; '${filename}' is likely corrupted",
+                        ("filename", fork_db_dat.generic_string()) );
+         }
+      } FC_CAPTURE_AND_RETHROW( (fork_db_dat) )
+   }
 
-      std::ofstream out( fork_db_dat.generic_string().c_str(), std::ios::out | std::ios::binary | std::ofstream::trunc );
-      fc::raw::pack( out, magic_number );
-      fc::raw::pack( out, max_supported_version ); // write out current version which is always max_supported_version
-      fc::raw::pack( out, *static_cast<block_header_state*>(&*my->root) );
-      uint32_t num_blocks_in_fork_db = my->index.size();
-      fc::raw::pack( out, unsigned_int{num_blocks_in_fork_db} );
+   void fork_database_impl::replay_journal( const fc::path& journal_path,
+                                            const std::function<void( block_timestamp_type,
+                                                                      const flat_set<digest_type>&,
+                                                                      const vector<digest_type>& )>& validator )
+   {
+      try {
+         string content;
+         fc::read_file_contents( journal_path, content );
+
+         if( content.size() < journal_header_size ) {
+            wlog( "fork database journal '${filename}' is missing its header; starting with an empty fork database",
+                  ("filename", journal_path.generic_string()) );
+            fc::remove( journal_path );
+            return;
+         }
 
-      const auto& indx = my->index.get<by_lib_block_num>();
+         fc::datastream<const char*> ds( content.data(), content.size() );
 
-      auto unvalidated_itr = indx.rbegin();
-      auto unvalidated_end = boost::make_reverse_iterator( indx.lower_bound( false ) );
+         uint32_t totem = 0;
+         fc::raw::unpack( ds, totem );
+         EOS_ASSERT( totem == fork_database::magic_number, fork_database_exception,
+                     "Fork database file '${filename}' has unexpected magic number: ${actual_totem}. Expected ${expected_totem}",
+                     ("filename", journal_path.generic_string())
+                     ("actual_totem", totem)
+                     ("expected_totem", fork_database::magic_number)
+         );
 
-      auto validated_itr = unvalidated_end;
-      auto validated_end = indx.rend();
+         uint32_t version = 0;
+         fc::raw::unpack( ds, version );
+         EOS_ASSERT( version >= first_journal_version && version <= fork_database::max_supported_version,
+                     fork_database_exception,
+                    "Unsupported version of fork database file '${filename}'. "
+                    "Fork database version is ${version} while code supports version(s) [${min},${max}]",
+                    ("filename", journal_path.generic_string())
+                    ("version", version)
+                    ("min", first_journal_version)
+                    ("max", fork_database::max_supported_version)
+         );
 
-      for(  bool unvalidated_remaining = (unvalidated_itr != unvalidated_end),
-                 validated_remaining   = (validated_itr != validated_end);
+         auto read_id = []( fc::datastream<const char*>& record ) {
+            block_id_type id;
+            fc::raw::unpack( record, id );
+            return id;
+         };
+
+         uint64_t end = journal_header_size;
+         while( content.size() - end >= record_prefix_size ) {
+            uint8_t  op = 0;
+            uint32_t size = 0;
+            fc::raw::unpack( ds, op );
+            fc::raw::unpack( ds, size );
+            if( ds.remaining() < size )
+               break; // torn tail left behind by a crash
+
+            fc::datastream<const char*> record( content.data() + end + record_prefix_size, size );
+            switch( static_cast<journal_op>(op) ) {
+               case journal_op::reset: {
+                  block_header_state bhs;
+                  fc::raw::unpack( record, bhs );
+                  reset( bhs );
+                  break;
+               }
+               case journal_op::add: {
+                  block_state s;
+                  fc::raw::unpack( record, s );
+                  // do not populate transaction_metadatas, they will be created as needed in apply_block with appropriate key recovery
+                  s.header_exts = s.block->validate_and_extract_header_extensions();
+                  add( std::make_shared<block_state>( move( s ) ), false, true, validator );
+                  break;
+               }
+               case journal_op::remove:
+                  remove( read_id( record ) );
+                  break;
+               case journal_op::mark_valid: {
+                  const auto id = read_id( record );
+                  auto b = self.get_block( id );
+                  EOS_ASSERT( b, fork_database_exception,
+                              "block state not in fork database; cannot mark as valid",
+                              ("id", id) );
+                  mark_valid( b );
+                  break;
+               }
+               case journal_op::advance_root:
+                  advance_root( read_id( record ) );
+                  break;
+               case journal_op::set_head:
+                  set_head( read_id( record ) );
+                  break;
+               case journal_op::rollback_head_to_root:
+                  rollback_head_to_root();
+                  break;
+               default:
+                  EOS_THROW( fork_database_exception, "unknown operation ${op} in fork database journal", ("op", op) );
+            }
 
-            unvalidated_remaining || validated_remaining;
+            ds.skip( size );
+            end += record_prefix_size + size;
+            ++journal_records;
+         }
 
-            unvalidated_remaining = (unvalidated_itr != unvalidated_end),
-            validated_remaining   = (validated_itr != validated_end)
-         )
-      {
-         auto itr = (validated_remaining ? validated_itr : unvalidated_itr);
-
-         if( unvalidated_remaining && validated_remaining ) {
-            if( first_preferred( **validated_itr, **unvalidated_itr ) ) {
-               itr = unvalidated_itr;
-               ++unvalidated_itr;
-            } else {
-               ++validated_itr;
-            }
-         } else if( unvalidated_remaining ) {
-            ++unvalidated_itr;
-         } else {
-            ++validated_itr;
+         if( end != content.size() ) {
+            wlog( "truncating ${n} bytes of incomplete records from fork database journal '${filename}'",
+                  ("n", content.size() - end)("filename", journal_path.generic_string()) );
+            boost::filesystem::resize_file( journal_path, end );
          }
+      } FC_CAPTURE_AND_RETHROW( (journal_path) )
+   }
 
-         fc::raw::pack( out, *(*itr) );
-      }
+   void fork_database_impl::append_journal( journal_op op, const vector<char>& payload ) {
+      if( !journal.is_open() ) return;
 
-      if( my->head ) {
-         fc::raw::pack( out, my->head->id );
-      } else {
-         elog( "head not set in fork database; '${filename}' will be corrupted",
-               ("filename", fork_db_dat.generic_string()) );
+      // write the whole record at once so that a crash leaves at most one incomplete record at the tail
+      vector<char> record( record_prefix_size + payload.size() );
+      fc::datastream<char*> ds( record.data(), record.size() );
+      fc::raw::pack( ds, static_cast<uint8_t>(op) );
+      fc::raw::pack( ds, static_cast<uint32_t>(payload.size()) );
+      ds.write( payload.data(), payload.size() );
+
+      journal.write( record.data(), record.size() );
+      journal.flush();
+      ++journal_records;
+   }
+
+   /// replaces the journal with one holding only the current root, blocks and head
+   void fork_database_impl::compact_journal() {
+      const auto journal_path = datadir / config::forkdb_journal_filename;
+      const auto tmp_path     = datadir / (std::string(config::forkdb_journal_filename) + ".tmp");
+
+      if( journal.is_open() )
+         journal.close();
+
+      journal.set_file_path( tmp_path );
+      journal.open( "wb" );
+      journal.write( (const char*)&fork_database::magic_number, sizeof(fork_database::magic_number) );
+      journal.write( (const char*)&fork_database::max_supported_version, sizeof(fork_database::max_supported_version) );
+      journal_records = 0;
+
+      if( root ) {
+         append_journal( journal_op::reset, fc::raw::pack( *static_cast<block_header_state*>(&*root) ) );
+
+         // parents must be written before their children
+         vector<block_state_ptr> blocks( index.begin(), index.end() );
+         std::sort( blocks.begin(), blocks.end(), []( const block_state_ptr& lhs, const block_state_ptr& rhs ) {
+            return lhs->block_num < rhs->block_num;
+         } );
+         for( const auto& b : blocks )
+            append_journal( journal_op::add, fc::raw::pack( *b ) );
+
+         append_journal( journal_op::set_head, fc::raw::pack( head->id ) );
       }
+      journal.flush();
+      journal.close();
+
+      fc::rename( tmp_path, journal_path );
+      journal.set_file_path( journal_path );
+      journal.open( "rb+" );
+      journal.seek_end( 0 );
+   }
+
+   void fork_database_impl::compact_journal_if_needed() {
+      // a freshly compacted journal holds a reset record, one add record per block and a set_head record
+      const uint64_t live_records = index.size() + 2;
+      if( journal_records >= min_records_to_compact && journal_records >= 2 * live_records )
+         compact_journal();
+   }
+
+   void fork_database::close() {
+      // the journal is kept up to date as the fork database changes, so there is nothing left to write out
+      if( my->journal.is_open() )
+         my->journal.close();
 
       my->index.clear();
    }
@@ -230,15 +400,26 @@ namespace eosio { namespace chain {
    }
 
    void fork_database::reset( const block_header_state& root_bhs ) {
-      my->index.clear();
-      my->root = std::make_shared<block_state>();
-      static_cast<block_header_state&>(*my->root) = root_bhs;
-      my->root->validated = true;
-      my->head = my->root;
+      my->reset( root_bhs );
+      if( my->journal.is_open() )
+         my->compact_journal();
+   }
+
+   void fork_database_impl::reset( const block_header_state& root_bhs ) {
+      index.clear();
+      root = std::make_shared<block_state>();
+      static_cast<block_header_state&>(*root) = root_bhs;
+      root->validated = true;
+      head = root;
    }
 
    void fork_database::rollback_head_to_root() {
-      auto& by_id_idx = my->index.get<by_block_id>();
+      my->rollback_head_to_root();
+      my->append_journal( journal_op::rollback_head_to_root );
+   }
+
+   void fork_database_impl::rollback_head_to_root() {
+      auto& by_id_idx = index.get<by_block_id>();
       auto itr = by_id_idx.begin();
       while (itr != by_id_idx.end()) {
          by_id_idx.modify( itr, [&]( block_state_ptr& bsp ) {
@@ -246,29 +427,34 @@ namespace eosio { namespace chain {
          } );
          ++itr;
       }
-      my->head = my->root;
+      head = root;
    }
 
    void fork_database::advance_root( const block_id_type& id ) {
-      EOS_ASSERT( my->root, fork_database_exception, "root not yet set" );
+      my->advance_root( id );
+      my->append_journal( journal_op::advance_root, fc::raw::pack( id ) );
+      my->compact_journal_if_needed();
+   }
 
-      auto new_root = get_block( id );
+   void fork_database_impl::advance_root( const block_id_type& id ) {
+      EOS_ASSERT( root, fork_database_exception, "root not yet set" );
+
+      auto new_root = self.get_block( id );
       EOS_ASSERT( new_root, fork_database_exception,
                   "cannot advance root to a block that does not exist in the fork database" );
       EOS_ASSERT( new_root->is_valid(), fork_database_exception,
                   "cannot advance root to a block that has not yet been validated" );
 
-
       vector<block_id_type> blocks_to_remove;
       for( auto b = new_root; b; ) {
          blocks_to_remove.push_back( b->header.previous );
-         b = get_block( blocks_to_remove.back() );
-         EOS_ASSERT( b || blocks_to_remove.back() == my->root->id, fork_database_exception, "invariant violation: orphaned branch was present in forked database" );
+         b = self.get_block( blocks_to_remove.back() );
+         EOS_ASSERT( b || blocks_to_remove.back() == root->id, fork_database_exception, "invariant violation: orphaned branch was present in forked database" );
       }
 
       // The new root block should be erased from the fork database index individually rather than with the remove method,
       // because we do not want the blocks branching off of it to be removed from the fork database.
-      my->index.erase( my->index.find( id ) );
+      index.erase( index.find( id ) );
 
       // The other blocks to be removed are removed using the remove method so that orphaned branches do not remain in the fork database.
       for( const auto& block_id : blocks_to_remove ) {
@@ -279,7 +465,7 @@ namespace eosio { namespace chain {
       // avoid mutating the block state at all, for example clearing the block shared pointer, because other
       // parts of the code which run asynchronously (e.g. mongo_db_plugin) may later expect it remain unmodified.
 
-      my->root = new_root;
+      root = new_root;
    }
 
    block_header_state_ptr fork_database::get_block_header( const block_id_type& id )const {
@@ -296,7 +482,7 @@ namespace eosio { namespace chain {
       return block_header_state_ptr();
    }
 
-   void fork_database_impl::add( const block_state_ptr& n,
+   bool fork_database_impl::add( const block_state_ptr& n,
                                  bool ignore_duplicate, bool validate,
                                  const std::function<void( block_timestamp_type,
                                                            const flat_set<digest_type>&,
@@ -323,7 +509,7 @@ namespace eosio { namespace chain {
 
       auto inserted = index.insert(n);
       if( !inserted.second ) {
-         if( ignore_duplicate ) return;
+         if( ignore_duplicate ) return false;
          EOS_THROW( fork_database_exception, "duplicate block added", ("id", n->id) );
       }
 
@@ -331,15 +517,18 @@ namespace eosio { namespace chain {
       if( (*candidate)->is_valid() ) {
          head = *candidate;
       }
+      return true;
    }
 
    void fork_database::add( const block_state_ptr& n, bool ignore_duplicate ) {
-      my->add( n, ignore_duplicate, false,
-               []( block_timestamp_type timestamp,
-                   const flat_set<digest_type>& cur_features,
-                   const vector<digest_type>& new_features )
-               {}
+      bool inserted = my->add( n, ignore_duplicate, false,
+                               []( block_timestamp_type timestamp,
+                                   const flat_set<digest_type>& cur_features,
+                                   const vector<digest_type>& new_features )
+                               {}
       );
+      if( inserted )
+         my->append_journal( journal_op::add, fc::raw::pack( *n ) );
    }
 
    const block_state_ptr& fork_database::root()const { return my->root; }
@@ -442,9 +631,14 @@ namespace eosio { namespace chain {
 
    /// remove all of the invalid forks built off of this id including this id
    void fork_database::remove( const block_id_type& id ) {
+      my->remove( id );
+      my->append_journal( journal_op::remove, fc::raw::pack( id ) );
+   }
+
+   void fork_database_impl::remove( const block_id_type& id ) {
       vector<block_id_type> remove_queue{id};
-      const auto& previdx = my->index.get<by_prev>();
-      const auto head_id = my->head->id;
+      const auto& previdx = index.get<by_prev>();
+      const auto head_id = head->id;
 
       for( uint32_t i = 0; i < remove_queue.size(); ++i ) {
          EOS_ASSERT( remove_queue[i] != head_id, fork_database_exception,
@@ -458,16 +652,23 @@ namespace eosio { namespace chain {
       }
 
       for( const auto& block_id : remove_queue ) {
-         auto itr = my->index.find( block_id );
-         if( itr != my->index.end() )
-            my->index.erase(itr);
+         auto itr = index.find( block_id );
+         if( itr != index.end() )
+            index.erase(itr);
       }
    }
 
    void fork_database::mark_valid( const block_state_ptr& h ) {
       if( h->validated ) return;
 
-      auto& by_id_idx = my->index.get<by_block_id>();
+      my->mark_valid( h );
+      my->append_journal( journal_op::mark_valid, fc::raw::pack( h->id ) );
+   }
+
+   void fork_database_impl::mark_valid( const block_state_ptr& h ) {
+      if( h->validated ) return;
+
+      auto& by_id_idx = index.get<by_block_id>();
 
       auto itr = by_id_idx.find( h->id );
       EOS_ASSERT( itr != by_id_idx.end(), fork_database_exception,
@@ -478,9 +679,22 @@ namespace eosio { namespace chain {
          bsp->validated = true;
       } );
 
-      auto candidate = my->index.get<by_lib_block_num>().begin();
-      if( first_preferred( **candidate, *my->head ) ) {
-         my->head = *candidate;
+      auto candidate = index.get<by_lib_block_num>().begin();
+      if( first_preferred( **candidate, *head ) ) {
+         head = *candidate;
+      }
+   }
+
+   void fork_database_impl::set_head( const block_id_type& id ) {
+      EOS_ASSERT( root, fork_database_exception, "root not yet set" );
+
+      if( root->id == id ) {
+         head = root;
+      } else {
+         head = self.get_block( id );
+         EOS_ASSERT( head, fork_database_exception,
+                     "could not find head ${id} while reconstructing fork database in '${dir}'; it is likely corrupted",
+                     ("id", id)("dir", datadir.generic_string()) );
       }
    }
 
@@ -70,6 +70,13 @@ struct abi_serializer {
    [[deprecated("use the overload with yield_function_t[=create_yield_function(max_serialization_time)]")]]
    fc::variant binary_to_variant( const std::string_view& type, fc::datastream<const char*>& binary, const fc::microseconds& max_serialization_time, bool short_path = false )const;
 
+   /**
+    *  Appends the JSON text of `binary` to `out`, walking the ABI over the packed bytes instead of building an
+    *  fc::variant first. The text is the same as fc::json::to_string( binary_to_variant( type, binary, ... ) ).
+    */
+   void binary_to_json( const std::string_view& type, const bytes& binary, std::string& out, const yield_function_t& yield, bool short_path = false )const;
+   void binary_to_json( const std::string_view& type, fc::datastream<const char*>& binary, std::string& out, const yield_function_t& yield, bool short_path = false )const;
+
    [[deprecated("use the overload with yield_function_t[=create_yield_function(max_serialization_time)]")]]
    bytes       variant_to_binary( const std::string_view& type, const fc::variant& var, const fc::microseconds& max_serialization_time, bool short_path = false )const;
    bytes       variant_to_binary( const std::string_view& type, const fc::variant& var, const yield_function_t& yield, bool short_path = false )const;
@@ -143,11 +150,24 @@ private:
    map<type_name, pair<unpack_function, pack_function>, std::less<>> built_in_types;
    void configure_built_in_types();
 
+   /// built-in types binary_to_json writes directly; the rest go through their unpack_function
+   typedef std::function<void(fc::datastream<const char*>&, std::string&)>  json_write_function;
+   map<type_name, json_write_function, std::less<>> json_writers;
+   /// structs binary_to_json writes through binary_to_variant because a field name appears more than once
+   std::set<type_name, std::less<>> structs_with_repeated_fields;
+
    fc::variant _binary_to_variant( const std::string_view& type, const bytes& binary, impl::binary_to_variant_context& ctx )const;
    fc::variant _binary_to_variant( const std::string_view& type, fc::datastream<const char*>& binary, impl::binary_to_variant_context& ctx )const;
    void        _binary_to_variant( const std::string_view& type, fc::datastream<const char*>& stream,
                                    fc::mutable_variant_object& obj, impl::binary_to_variant_context& ctx )const;
 
+   /// @return false if the value written was null
+   bool        _binary_to_json( const std::string_view& type, fc::datastream<const char*>& stream, std::string& out,
+                                impl::binary_to_variant_context& ctx )const;
+   /// @return number of fields written
+   size_t      _binary_to_json_fields( const std::string_view& type, fc::datastream<const char*>& stream, std::string& out,
+                                       impl::binary_to_variant_context& ctx )const;
+
    bytes       _variant_to_binary( const std::string_view& type, const fc::variant& var, impl::variant_to_binary_context& ctx )const;
    void        _variant_to_binary( const std::string_view& type, const fc::variant& var,
                                    fc::datastream<char*>& ds, impl::variant_to_binary_context& ctx )const;
@@ -10,11 +10,11 @@ typedef __uint128_t uint128_t;
 
 const static auto default_blocks_dir_name    = "blocks";
 const static auto reversible_blocks_dir_name = "reversible";
-const static auto default_reversible_cache_size = 340*1024*1024ll;/// 1MB * 340 blocks based on 21 producer BFT delay
-const static auto default_reversible_guard_size = 2*1024*1024ll;/// 1MB * 340 blocks based on 21 producer BFT delay
+const static auto default_reversible_cache_size = 340*1024*1024ll;/// size used to open reversible blocks databases written by older versions
 
 const static auto default_state_dir_name     = "state";
-const static auto forkdb_filename            = "fork_db.dat";
+const static auto forkdb_filename            = "fork_db.dat"; /// written by older versions; imported on open
+const static auto forkdb_journal_filename    = "fork_db.log";
 const static auto default_state_size            = 1*1024*1024*1024ll;
 const static auto default_state_guard_size      =    128*1024*1024ll;
 
@@ -69,8 +69,6 @@ namespace eosio { namespace chain {
             path                     state_dir              =  chain::config::default_state_dir_name;
             uint64_t                 state_size             =  chain::config::default_state_size;
             uint64_t                 state_guard_size       =  chain::config::default_state_guard_size;
-            uint64_t                 reversible_cache_size  =  chain::config::default_reversible_cache_size;
-            uint64_t                 reversible_guard_size  =  chain::config::default_reversible_guard_size;
             uint32_t                 sig_cpu_bill_pct       =  chain::config::default_sig_cpu_bill_pct;
             uint16_t                 thread_pool_size       =  chain::config::default_controller_thread_pool_size;
             bool                     read_only              =  false;
@@ -156,6 +154,14 @@ namespace eosio { namespace chain {
          void sign_block( const signer_callback_type& signer_callback );
          void commit_block();
 
+         /**
+          * Validates the header and producer signature of b on the thread pool.
+          *
+          * b may build on a block that was passed to create_block_state_future but has not been pushed yet, so that
+          * a run of blocks can be validated ahead of being pushed in order; such blocks also have their transaction
+          * signatures recovered up front.
+          * Calling this again for a block that has not been pushed yet returns the work already started for it.
+          */
          std::future<block_state_ptr> create_block_state_future( const signed_block_ptr& b );
 
          /**
@@ -262,7 +268,6 @@ namespace eosio { namespace chain {
          void validate_expiration( const transaction& t )const;
          void validate_tapos( const transaction& t )const;
          void validate_db_available_size() const;
-         void validate_reversible_available_size() const;
 
          bool is_protocol_feature_activated( const digest_type& feature_digest )const;
          bool is_builtin_activated( builtin_protocol_feature_t f )const;
@@ -283,6 +288,9 @@ namespace eosio { namespace chain {
          chain_id_type get_chain_id()const;
 
          db_read_mode get_read_mode()const;
+         /// true if the state database is in process private memory (heap or locked map mode without hugepages),
+         /// so a forked child process keeps a stable copy-on-write image of it
+         bool is_state_in_private_memory()const;
          validation_mode get_validation_mode()const;
 
          void set_subjective_cpu_leeway(fc::microseconds leeway);
@@ -16,6 +16,12 @@ namespace eosio { namespace chain {
     * database tracks the longest chain and the last irreversible block number. All
     * blocks older than the last irreversible block are freed after emitting the
     * irreversible signal.
+    *
+    * Every change is appended to a journal (fork_db.log) in the data directory as it is made, so closing is
+    * cheap and the fork database survives a crash. Open replays every record in the journal, re-adding each
+    * block just as the old fork_db.dat load did; a record torn by a crash is dropped. Once the journal holds
+    * at least twice the records needed to describe the current tree it is rewritten as the root advances,
+    * which keeps that replay within a small multiple of the size of the tree.
     */
    class fork_database {
       public:
@@ -19,4 +19,26 @@ namespace eosio { namespace chain {
     */
    digest_type merkle( vector<digest_type> ids );
 
+   /**
+    *  Accumulates digests one at a time and produces the same root as merkle() over all of them.
+    *
+    *  Complete subtrees are folded as soon as they fill, so appending costs amortized one hash and get_root() only
+    *  has to combine the O(log n) remaining subtrees. Unlike incremental_merkle, append() does not compute an
+    *  intermediate root, keeping the total hashing work equal to that of merkle(). The state is small enough that
+    *  copying it is a cheap way to take a restore point.
+    */
+   class merkle_accumulator {
+      public:
+         void append( const digest_type& digest );
+
+         digest_type get_root()const;
+
+         uint64_t size()const { return _node_count; }
+
+      private:
+         uint64_t            _node_count = 0;
+         /// _subtrees[i] is the root of a complete subtree of 2^i digests when bit i of _node_count is set
+         vector<digest_type> _subtrees;
+   };
+
 } } /// eosio::chain
@@ -0,0 +1,76 @@
+#pragma once
+#include <fc/filesystem.hpp>
+#include <fc/io/cfile.hpp>
+#include <eosio/chain/block.hpp>
+
+#include <deque>
+
+namespace eosio { namespace chain {
+
+   /* The reversible block log persists blocks that have been applied but are not yet irreversible so that they can
+    * be replayed on restart. It is a single append only file in the reversible blocks directory:
+    *
+    * +---------+-----------+------+---------------+-----------+------+---------------+-----+
+    * | Version | Block Num | Size | Packed Block  | Block Num | Size | Packed Block  | ... |
+    * +---------+-----------+------+---------------+-----------+------+---------------+-----+
+    *
+    * Block numbers are consecutive. Popping blocks truncates the file. Blocks that become irreversible are only
+    * dropped from the in memory index; once they take up at least half of the file the remaining blocks are copied
+    * to a new file which replaces the old one. A partially written tail, left behind by a crash, is truncated when
+    * the file is opened.
+    *
+    * A reversible blocks database left behind by an older version (shared_memory.bin) is imported on open.
+    *
+    * Tools inspecting the blocks of a possibly running node open the log read_only: an incomplete tail is ignored
+    * rather than truncated, and nothing is created, imported or removed.
+    */
+   class reversible_block_log {
+      public:
+         enum class open_mode {
+            read_write,
+            read_only
+         };
+
+         explicit reversible_block_log( const fc::path& reversible_dir, open_mode mode = open_mode::read_write );
+
+         void append( const signed_block_ptr& b );
+
+         /// drops block_num and every block after it
+         void remove_from( uint32_t block_num );
+
+         /// drops block_num and every block before it
+         void remove_through( uint32_t block_num );
+
+         void clear();
+
+         bool             empty()const { return entries.empty(); }
+         uint32_t         first_block_num()const { return first_num; }
+         uint32_t         last_block_num()const { return entries.empty() ? 0 : first_num + entries.size() - 1; }
+
+         /// nullptr if block_num is not in the log
+         signed_block_ptr        read_block( uint32_t block_num )const;
+         optional<block_id_type> read_block_id( uint32_t block_num )const;
+
+         static const uint32_t    version;
+         static const char* const file_name;
+
+      private:
+         struct entry {
+            uint64_t      pos  = 0; ///< position of the packed block
+            uint32_t      size = 0;
+            block_id_type id;
+         };
+
+         void open();
+         void import_legacy_database();
+         void compact();
+         void assert_writable()const;
+
+         fc::path          dir;
+         open_mode         mode;
+         mutable fc::cfile file;
+         std::deque<entry> entries; ///< entries[i] is block first_num + i
+         uint32_t          first_num = 0;
+   };
+
+} } /// eosio::chain
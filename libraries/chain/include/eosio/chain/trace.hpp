@@ -62,6 +62,7 @@ namespace eosio { namespace chain {
       fc::optional<fc::exception>                except;
       fc::optional<uint64_t>                     error_code;
       std::exception_ptr                         except_ptr;
+      flat_set<account_name>                     table_codes_read; ///< contracts other than the receiver whose tables were looked up, not reflected
    };
 
 } }  /// namespace eosio::chain
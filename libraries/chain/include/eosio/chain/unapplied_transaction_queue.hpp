@@ -8,6 +8,7 @@
 #include <boost/multi_index/sequenced_index.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
+#include <boost/multi_index/composite_key.hpp>
 
 namespace fc {
   inline std::size_t hash_value( const fc::sha256& v ) {
@@ -30,9 +31,28 @@ struct unapplied_transaction {
    const transaction_metadata_ptr trx_meta;
    const fc::time_point           expiry;
    trx_enum_type                  trx_type = trx_enum_type::unknown;
+   flat_set<account_name>         footprint; ///< accounts touched or whose tables were read by the last successful run, empty if unknown
+   int64_t                        priority = 0; ///< among aborted trxs higher priority is retried first, 0 for the other types
 
    const transaction_id_type& id()const { return trx_meta->id(); }
 
+   /// true if the footprint is known and none of `accounts` is in it
+   bool untouched_by( const flat_set<account_name>& accounts )const {
+      if( footprint.empty() ) return false;
+      auto fitr = footprint.begin(), fend = footprint.end();
+      auto aitr = accounts.begin(), aend = accounts.end();
+      while( fitr != fend && aitr != aend ) {
+         if( *fitr < *aitr ) {
+            ++fitr;
+         } else if( *aitr < *fitr ) {
+            ++aitr;
+         } else {
+            return false;
+         }
+      }
+      return true;
+   }
+
    unapplied_transaction(const unapplied_transaction&) = delete;
    unapplied_transaction() = delete;
    unapplied_transaction& operator=(const unapplied_transaction&) = delete;
@@ -61,13 +81,24 @@ private:
          hashed_unique< tag<by_trx_id>,
                const_mem_fun<unapplied_transaction, const transaction_id_type&, &unapplied_transaction::id>
          >,
-         ordered_non_unique< tag<by_type>, member<unapplied_transaction, trx_enum_type, &unapplied_transaction::trx_type> >,
+         ordered_non_unique< tag<by_type>,
+               composite_key< unapplied_transaction,
+                  member<unapplied_transaction, trx_enum_type, &unapplied_transaction::trx_type>,
+                  member<unapplied_transaction, int64_t, &unapplied_transaction::priority>
+               >,
+               composite_key_compare< std::less<trx_enum_type>, std::greater<int64_t> >
+         >,
          ordered_non_unique< tag<by_expiry>, member<unapplied_transaction, const fc::time_point, &unapplied_transaction::expiry> >
       >
    > unapplied_trx_queue_type;
 
    unapplied_trx_queue_type queue;
    process_mode mode = process_mode::speculative_producer;
+   std::function<int64_t(const transaction_metadata_ptr&)> priority_of;
+
+   int64_t priority( const transaction_metadata_ptr& trx )const {
+      return priority_of ? priority_of( trx ) : 0;
+   }
 
 public:
 
@@ -78,6 +109,13 @@ public:
       mode = new_mode;
    }
 
+   /// only aborted transactions are ordered by priority; persisted and forked transactions keep insertion order
+   /// since later ones may depend on earlier ones. Without a priority function every type keeps insertion order.
+   void set_priority_function( std::function<int64_t(const transaction_metadata_ptr&)> f ) {
+      FC_ASSERT( empty(), "set_priority_function, queue required to be empty" );
+      priority_of = std::move( f );
+   }
+
    bool empty() const {
       return queue.empty();
    }
@@ -91,7 +129,7 @@ public:
    }
 
    bool contains_persisted()const {
-      return queue.get<by_type>().find( trx_enum_type::persisted ) != queue.get<by_type>().end();
+      return queue.get<by_type>().find( std::make_tuple( trx_enum_type::persisted ) ) != queue.get<by_type>().end();
    }
 
    bool is_persisted(const transaction_metadata_ptr& trx)const {
@@ -152,19 +190,24 @@ public:
       if( mode == process_mode::non_speculative || mode == process_mode::speculative_non_producer ) return;
       for( auto& trx : aborted_trxs ) {
          fc::time_point expiry = trx->packed_trx()->expiration();
-         queue.insert( { std::move( trx ), expiry, trx_enum_type::aborted } );
+         int64_t p = priority( trx );
+         queue.insert( { std::move( trx ), expiry, trx_enum_type::aborted, {}, p } );
       }
    }
 
-   void add_persisted( const transaction_metadata_ptr& trx ) {
+   /// @param footprint accounts touched by the successful run of trx, see unapplied_transaction::untouched_by
+   void add_persisted( const transaction_metadata_ptr& trx, flat_set<account_name> footprint = {} ) {
       if( mode == process_mode::non_speculative ) return;
       auto itr = queue.get<by_trx_id>().find( trx->id() );
       if( itr == queue.get<by_trx_id>().end() ) {
          fc::time_point expiry = trx->packed_trx()->expiration();
-         queue.insert( { trx, expiry, trx_enum_type::persisted } );
-      } else if( itr->trx_type != trx_enum_type::persisted ) {
-         queue.get<by_trx_id>().modify( itr, [](auto& un){
+         queue.insert( { trx, expiry, trx_enum_type::persisted, std::move( footprint ) } );
+      } else {
+         // persisted transactions keep the order they were applied in, whatever priority they had as aborted
+         queue.get<by_trx_id>().modify( itr, [&footprint](auto& un){
             un.trx_type = trx_enum_type::persisted;
+            un.footprint = std::move( footprint );
+            un.priority = 0;
          } );
       }
    }
@@ -174,8 +217,8 @@ public:
    iterator begin() { return queue.get<by_type>().begin(); }
    iterator end() { return queue.get<by_type>().end(); }
 
-   iterator persisted_begin() { return queue.get<by_type>().lower_bound( trx_enum_type::persisted ); }
-   iterator persisted_end() { return queue.get<by_type>().upper_bound( trx_enum_type::persisted ); }
+   iterator persisted_begin() { return queue.get<by_type>().lower_bound( std::make_tuple( trx_enum_type::persisted ) ); }
+   iterator persisted_end() { return queue.get<by_type>().upper_bound( std::make_tuple( trx_enum_type::persisted ) ); }
 
    iterator erase( iterator itr ) { return queue.get<by_type>().erase( itr ); }
 
@@ -24,7 +24,7 @@ class executor {
       executor(const code_cache_base& cc);
       ~executor();
 
-      void execute(const code_descriptor& code, const memory& mem, apply_context& context);
+      void execute(const code_descriptor& code, memory& mem, apply_context& context);
 
    private:
       uint8_t* code_mapping;
@@ -8,6 +8,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include <algorithm>
+
 namespace eosio { namespace chain { namespace eosvmoc {
 
 class memory {
@@ -33,6 +35,14 @@ class memory {
       uint8_t* const zero_page_memory_base() const { return zeropage_base; }
       uint8_t* const full_page_memory_base() const { return fullpage_base; }
 
+      //zero linear memory ahead of an execution. Only the pages executions since the last reset had accessible are
+      // cleared, so the cost follows what the previous execution used rather than the largest memory ever seen
+      void reset_linear_memory();
+      //record that an execution had up to `pages` wasm pages of linear memory accessible at some point
+      void mark_linear_memory_dirty(uint64_t pages) { dirty_pages = std::max(dirty_pages, pages); }
+      //wasm pages the next reset_linear_memory() clears
+      uint64_t dirty_linear_memory_pages() const { return dirty_pages; }
+
       control_block* const get_control_block() const { return reinterpret_cast<control_block* const>(zeropage_base - cb_offset);}
 
       //these two are really only inteded for SEGV handling
@@ -57,6 +67,9 @@ class memory {
 
       uint8_t* zeropage_base;
       uint8_t* fullpage_base;
+
+      //linear memory at or beyond this many wasm pages is known to be zero
+      uint64_t dirty_pages = 0;
 };
 
 }}}
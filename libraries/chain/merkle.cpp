@@ -49,4 +49,37 @@ digest_type merkle(vector<digest_type> ids) {
    return ids.front();
 }
 
+void merkle_accumulator::append( const digest_type& digest ) {
+   digest_type carry = digest;
+   size_t level = 0;
+   for( ; _node_count & (uint64_t(1) << level); ++level )
+      carry = digest_type::hash( make_canonical_pair( _subtrees[level], carry ) );
+
+   if( level == _subtrees.size() )
+      _subtrees.push_back( carry );
+   else
+      _subtrees[level] = carry;
+   ++_node_count;
+}
+
+digest_type merkle_accumulator::get_root()const {
+   if( 0 == _node_count ) { return digest_type(); }
+
+   // walk up from the leaves carrying the rightmost, partially filled node of each level; merkle() pairs a lone
+   // node at the end of a level with itself
+   optional<digest_type> partial;
+   size_t level = 0;
+   for( ; (uint64_t(1) << level) < _node_count; ++level ) {
+      const bool complete = _node_count & (uint64_t(1) << level);
+      if( complete && partial )
+         partial = digest_type::hash( make_canonical_pair( _subtrees[level], *partial ) );
+      else if( complete )
+         partial = digest_type::hash( make_canonical_pair( _subtrees[level], _subtrees[level] ) );
+      else if( partial )
+         partial = digest_type::hash( make_canonical_pair( *partial, *partial ) );
+   }
+
+   return partial ? *partial : _subtrees[level];
+}
+
 } } // eosio::chain
@@ -0,0 +1,251 @@
+#include <eosio/chain/reversible_block_log.hpp>
+#include <eosio/chain/reversible_block_object.hpp>
+#include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/config.hpp>
+#include <fc/io/raw.hpp>
+
+#include <boost/filesystem.hpp>
+
+namespace eosio { namespace chain {
+
+   const uint32_t reversible_block_log::version = 1;
+   const char* const reversible_block_log::file_name = "reversible_blocks.log";
+
+   namespace {
+      constexpr uint64_t version_size = sizeof(uint32_t);
+      constexpr uint64_t prefix_size  = sizeof(uint32_t) + sizeof(uint32_t); // block num, size
+   }
+
+   reversible_block_log::reversible_block_log( const fc::path& reversible_dir, open_mode mode )
+   :dir( reversible_dir )
+   ,mode( mode )
+   {
+      if( mode == open_mode::read_only ) {
+         if( fc::exists( dir / file_name ) )
+            open();
+         if( fc::exists( dir / "shared_memory.bin" ) )
+            wlog( "reversible blocks in ${file} are not read in read only mode, they are imported when nodeos starts",
+                  ("file", (dir / "shared_memory.bin").generic_string()) );
+         return;
+      }
+      if( !fc::is_directory( dir ) )
+         fc::create_directories( dir );
+      open();
+      import_legacy_database();
+   }
+
+   void reversible_block_log::open() {
+      file.set_file_path( dir / file_name );
+      if( mode == open_mode::read_only ) {
+         file.open( "rb" );
+      } else {
+         file.open( "ab+" ); // creates the file if it does not exist
+         file.close();
+         file.open( "rb+" );
+      }
+
+      file.seek_end( 0 );
+      const uint64_t size = file.tellp();
+      if( size < version_size && mode == open_mode::read_only ) {
+         return; // being created by a node
+      }
+      if( size < version_size ) {
+         file.seek( 0 );
+         boost::filesystem::resize_file( file.get_file_path(), 0 );
+         file.write( (const char*)&version, sizeof(version) );
+         file.flush();
+         return;
+      }
+
+      uint32_t v = 0;
+      file.seek( 0 );
+      file.read( (char*)&v, sizeof(v) );
+      EOS_ASSERT( v == version, reversible_blocks_exception,
+                  "unsupported version ${v} of ${file}", ("v", v)("file", file.get_file_path().generic_string()) );
+
+      uint64_t pos = version_size;
+      std::vector<char> packed;
+      while( pos + prefix_size <= size ) {
+         uint32_t num = 0;
+         entry e;
+         file.seek( pos );
+         file.read( (char*)&num, sizeof(num) );
+         file.read( (char*)&e.size, sizeof(e.size) );
+         e.pos = pos + prefix_size;
+         if( e.pos + e.size > size )
+            break;
+         if( !entries.empty() && num != first_num + entries.size() )
+            break;
+         packed.resize( e.size );
+         file.read( packed.data(), packed.size() );
+         try {
+            fc::datastream<const char*> ds( packed.data(), packed.size() );
+            block_header h;
+            fc::raw::unpack( ds, h );
+            if( h.block_num() != num )
+               break;
+            e.id = h.id();
+         } catch( const fc::exception& ) {
+            break;
+         }
+         if( entries.empty() )
+            first_num = num;
+         entries.push_back( e );
+         pos = e.pos + e.size;
+      }
+
+      if( pos != size && mode == open_mode::read_only ) {
+         ilog( "ignoring ${n} bytes of incomplete reversible blocks at the end of ${file}",
+               ("n", size - pos)("file", file.get_file_path().generic_string()) );
+      } else if( pos != size ) {
+         wlog( "truncating ${n} bytes of incomplete reversible blocks from ${file}",
+               ("n", size - pos)("file", file.get_file_path().generic_string()) );
+         file.flush();
+         boost::filesystem::resize_file( file.get_file_path(), pos );
+      }
+      if( !entries.empty() )
+         ilog( "reversible blocks ${first} through ${last}", ("first", first_block_num())("last", last_block_num()) );
+   }
+
+   void reversible_block_log::import_legacy_database() {
+      const auto legacy_file = dir / "shared_memory.bin";
+      if( !fc::exists( legacy_file ) )
+         return;
+
+      if( empty() ) {
+         ilog( "importing reversible blocks from ${file}", ("file", legacy_file.generic_string()) );
+         try {
+            // left dirty by an unclean shutdown of an older version; whatever is readable is still worth keeping
+            chainbase::database legacy( dir, chainbase::database::read_only, config::default_reversible_cache_size, true );
+            legacy.add_index<reversible_block_index>();
+            const auto& idx = legacy.get_index<reversible_block_index,by_num>();
+            for( auto itr = idx.begin(); itr != idx.end(); ++itr )
+               append( itr->get_block() );
+         } catch( const fc::exception& e ) {
+            wlog( "imported ${n} reversible blocks, the rest of ${file} could not be read and is dropped: ${e}",
+                  ("n", entries.size())("file", legacy_file.generic_string())("e", e.to_detail_string()) );
+         } catch( const std::exception& e ) {
+            wlog( "imported ${n} reversible blocks, the rest of ${file} could not be read and is dropped: ${e}",
+                  ("n", entries.size())("file", legacy_file.generic_string())("e", e.what()) );
+         }
+      }
+      fc::remove( legacy_file );
+      fc::remove( dir / "shared_memory.meta" );
+   }
+
+   void reversible_block_log::assert_writable()const {
+      EOS_ASSERT( mode == open_mode::read_write, reversible_blocks_exception,
+                  "reversible block log in ${dir} is open read only", ("dir", dir.generic_string()) );
+   }
+
+   void reversible_block_log::append( const signed_block_ptr& b ) {
+      assert_writable();
+      const uint32_t num = b->block_num();
+      EOS_ASSERT( entries.empty() || num == last_block_num() + 1, reversible_blocks_exception,
+                  "block ${num} does not follow the last reversible block ${last}",
+                  ("num", num)("last", last_block_num()) );
+
+      const auto packed = fc::raw::pack( *b );
+      entry e;
+      e.size = packed.size();
+      e.id   = b->id();
+
+      file.seek_end( 0 );
+      e.pos = file.tellp() + prefix_size;
+      file.write( (const char*)&num, sizeof(num) );
+      file.write( (const char*)&e.size, sizeof(e.size) );
+      file.write( packed.data(), packed.size() );
+      file.flush();
+
+      if( entries.empty() )
+         first_num = num;
+      entries.push_back( e );
+   }
+
+   void reversible_block_log::remove_from( uint32_t block_num ) {
+      assert_writable();
+      if( entries.empty() || block_num > last_block_num() )
+         return;
+      if( block_num <= first_num )
+         return clear();
+
+      const auto keep = block_num - first_num;
+      const uint64_t end = entries[keep].pos - prefix_size;
+      entries.resize( keep );
+      file.flush();
+      boost::filesystem::resize_file( file.get_file_path(), end );
+   }
+
+   void reversible_block_log::remove_through( uint32_t block_num ) {
+      assert_writable();
+      if( entries.empty() || block_num < first_num )
+         return;
+      if( block_num >= last_block_num() )
+         return clear();
+
+      entries.erase( entries.begin(), entries.begin() + (block_num - first_num + 1) );
+      first_num = block_num + 1;
+
+      file.seek_end( 0 );
+      const uint64_t begin = entries.front().pos - prefix_size;
+      const uint64_t dead  = begin - version_size;
+      if( dead >= file.tellp() - begin )
+         compact();
+   }
+
+   void reversible_block_log::clear() {
+      assert_writable();
+      entries.clear();
+      first_num = 0;
+      file.flush();
+      boost::filesystem::resize_file( file.get_file_path(), version_size );
+   }
+
+   void reversible_block_log::compact() {
+      const auto tmp_path = dir / (std::string(file_name) + ".tmp");
+      fc::cfile tmp;
+      tmp.set_file_path( tmp_path );
+      tmp.open( "wb" );
+      tmp.write( (const char*)&version, sizeof(version) );
+
+      std::vector<char> packed;
+      uint32_t num = first_num;
+      for( auto& e : entries ) {
+         packed.resize( e.size );
+         file.seek( e.pos );
+         file.read( packed.data(), packed.size() );
+         const uint64_t pos = tmp.tellp();
+         tmp.write( (const char*)&num, sizeof(num) );
+         tmp.write( (const char*)&e.size, sizeof(e.size) );
+         tmp.write( packed.data(), packed.size() );
+         e.pos = pos + prefix_size;
+         ++num;
+      }
+      tmp.flush();
+      tmp.close();
+
+      file.close();
+      fc::rename( tmp_path, dir / file_name );
+      file.open( "rb+" );
+   }
+
+   signed_block_ptr reversible_block_log::read_block( uint32_t block_num )const {
+      if( entries.empty() || block_num < first_num || block_num > last_block_num() )
+         return {};
+      const auto& e = entries[block_num - first_num];
+      std::vector<char> packed( e.size );
+      file.seek( e.pos );
+      file.read( packed.data(), packed.size() );
+      fc::datastream<const char*> ds( packed.data(), packed.size() );
+      auto result = std::make_shared<signed_block>();
+      fc::raw::unpack( ds, *result );
+      return result;
+   }
+
+   optional<block_id_type> reversible_block_log::read_block_id( uint32_t block_num )const {
+      if( entries.empty() || block_num < first_num || block_num > last_block_num() )
+         return {};
+      return entries[block_num - first_num].id;
+   }
+
+} } /// eosio::chain
@@ -147,7 +147,7 @@ executor::executor(const code_cache_base& cc) {
    mapping_is_executable = true;
 }
 
-void executor::execute(const code_descriptor& code, const memory& mem, apply_context& context) {
+void executor::execute(const code_descriptor& code, memory& mem, apply_context& context) {
    if(mapping_is_executable == false) {
       mprotect(code_mapping, code_mapping_size, PROT_EXEC|PROT_READ);
       mapping_is_executable = true;
@@ -156,7 +156,7 @@ void executor::execute(const code_descriptor& code, const memory& mem, apply_con
    //prepare initial memory, mutable globals, and table data
    if(code.starting_memory_pages > 0 ) {
       arch_prctl(ARCH_SET_GS, (unsigned long*)(mem.zero_page_memory_base()+code.starting_memory_pages*memory::stride));
-      memset(mem.full_page_memory_base(), 0, 64u*1024u*code.starting_memory_pages);
+      mem.reset_linear_memory();
    }
    else
       arch_prctl(ARCH_SET_GS, (unsigned long*)mem.zero_page_memory_base());
@@ -173,6 +173,7 @@ void executor::execute(const code_descriptor& code, const memory& mem, apply_con
    cb->eptr = &executors_exception_ptr;
    cb->current_call_depth_remaining = eosio::chain::wasm_constraints::maximum_call_depth+2;
    cb->current_linear_memory_pages = code.starting_memory_pages;
+   cb->peak_linear_memory_pages = code.starting_memory_pages;
    cb->first_invalid_memory_address = code.starting_memory_pages*64*1024;
    cb->full_linear_memory_start = (char*)mem.full_page_memory_base();
    cb->jmp = &executors_sigjmp_buf;
@@ -187,8 +188,11 @@ void executor::execute(const code_descriptor& code, const memory& mem, apply_con
    }, this);
    context.trx_context.checktime(); //catch any expiration that might have occurred before setting up callback
 
-   auto cleanup = fc::make_scoped_exit([cb, &tt=context.trx_context.transaction_timer](){
+   auto cleanup = fc::make_scoped_exit([cb, &mem, &tt=context.trx_context.transaction_timer](){
       cb->is_running = false;
+      //memory can shrink via a negative grow, so anything up to the peak may have been written
+      if(cb->peak_linear_memory_pages > 0)
+         mem.mark_linear_memory_dirty(cb->peak_linear_memory_pages);
       cb->bounce_buffers->clear();
       tt.set_expiration_callback(nullptr, nullptr);
    });
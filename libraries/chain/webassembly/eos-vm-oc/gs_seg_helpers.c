@@ -23,6 +23,8 @@ int32_t eos_vm_oc_grow_memory(int32_t grow, int32_t max) {
    arch_prctl(ARCH_SET_GS, (unsigned long*)current_gs);
    cb_ptr->current_linear_memory_pages += grow_amount;
    cb_ptr->first_invalid_memory_address += grow_amount*64*1024;
+   if(cb_ptr->current_linear_memory_pages > cb_ptr->peak_linear_memory_pages)
+      cb_ptr->peak_linear_memory_pages = cb_ptr->current_linear_memory_pages;
 
    if(grow_amount > 0)
       memset(cb_ptr->full_linear_memory_start + previous_page_count*64u*1024u, 0, grow_amount*64u*1024u);
@@ -3,6 +3,7 @@
 
 #include <fc/scoped_exit.hpp>
 
+#include <string.h>
 #include <unistd.h>
 #include <sys/syscall.h>
 #include <sys/mman.h>
@@ -40,6 +41,11 @@ memory::memory() {
       intrinsic_jump_table[-intrinsic.second.ordinal] = (uintptr_t)intrinsic.second.function_ptr;
 }
 
+void memory::reset_linear_memory() {
+   memset(fullpage_base, 0, dirty_pages*64u*1024u);
+   dirty_pages = 0;
+}
+
 memory::~memory() {
    munmap(mapbase, mapsize);
 }
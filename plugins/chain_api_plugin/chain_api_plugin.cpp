@@ -1,28 +1,175 @@
 #include <eosio/chain_api_plugin/chain_api_plugin.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/thread_utils.hpp>
 
 #include <fc/io/json.hpp>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
 namespace eosio {
 
 static appbase::abstract_plugin& _chain_api_plugin = app().register_plugin<chain_api_plugin>();
 
 using namespace eosio;
 
+/**
+ * Runs read only api calls on a pool of threads while the main thread is parked.
+ *
+ * Calls are queued from the http threads. The first call queued posts a read window to the main thread; when the
+ * window runs, the main thread hands everything queued so far to the read threads and blocks until they are done
+ * or the window time has elapsed. Nothing modifies chainbase while the main thread is blocked, so the read threads
+ * all see the same consistent state. Calls not started before the window closes wait for the next window, which
+ * is posted behind whatever the main thread has queued in the meantime (e.g. the next block). At most max_queued
+ * calls wait at a time; further calls are rejected so the http plugin can answer them with a 503.
+ */
+class read_only_executor : public std::enable_shared_from_this<read_only_executor> {
+public:
+   read_only_executor( uint16_t num_threads, fc::microseconds window_time, uint32_t max_queued, int priority )
+   : num_threads( num_threads ), window_time( window_time ), max_queued( max_queued ), priority( priority ) {
+      thread_pool.emplace( "chainro", num_threads );
+   }
+
+   /// @return false when max_queued calls are already waiting and the task was not queued
+   bool post( std::function<void()> task ) {
+      bool schedule = false;
+      {
+         std::lock_guard<std::mutex> g( mtx );
+         if( queue.size() >= max_queued )
+            return false;
+         queue.emplace_back( std::move( task ) );
+         schedule = !window_scheduled;
+         window_scheduled = true;
+      }
+      if( schedule )
+         schedule_window();
+      return true;
+   }
+
+   void stop() {
+      if( thread_pool ) {
+         thread_pool->stop();
+         thread_pool.reset();
+      }
+   }
+
+private:
+   void schedule_window() {
+      app().post( priority, [self = shared_from_this()]() {
+         self->run_window();
+      } );
+   }
+
+   // main thread
+   void run_window() {
+      if( !thread_pool ) return; // shutting down
+
+      std::unique_lock<std::mutex> g( mtx );
+      window_tasks.assign( std::make_move_iterator( queue.begin() ), std::make_move_iterator( queue.end() ) );
+      queue.clear();
+      next_task = 0;
+      active_workers = std::min<size_t>( num_threads, window_tasks.size() );
+      const fc::time_point deadline = fc::time_point::now() + window_time;
+      for( size_t i = 0; i < active_workers; ++i ) {
+         boost::asio::post( thread_pool->get_executor(), [this, deadline]() {
+            run_tasks( deadline );
+         } );
+      }
+      cv.wait( g, [this]() { return active_workers == 0; } );
+
+      // calls that did not get a turn go back to the front of the line
+      queue.insert( queue.begin(), std::make_move_iterator( window_tasks.begin() + next_task ),
+                                   std::make_move_iterator( window_tasks.end() ) );
+      window_tasks.clear();
+      const bool schedule = !queue.empty();
+      window_scheduled = schedule;
+      g.unlock();
+
+      if( schedule )
+         schedule_window();
+   }
+
+   // read thread
+   void run_tasks( const fc::time_point& deadline ) {
+      std::unique_lock<std::mutex> g( mtx );
+      while( next_task < window_tasks.size() && fc::time_point::now() < deadline ) {
+         auto task = std::move( window_tasks[next_task++] );
+         g.unlock();
+         try {
+            task();
+         } catch( ... ) {
+            elog( "Unexpected exception in read only api call" );
+         }
+         g.lock();
+      }
+      if( --active_workers == 0 )
+         cv.notify_one();
+   }
+
+   const size_t                             num_threads;
+   const fc::microseconds                   window_time;
+   const size_t                             max_queued;
+   const int                                priority;
+   fc::optional<chain::named_thread_pool>   thread_pool;
+
+   std::mutex                               mtx;
+   std::condition_variable                  cv;
+   std::deque<std::function<void()>>        queue;
+   bool                                     window_scheduled = false;
+   std::vector<std::function<void()>>       window_tasks;
+   size_t                                   next_task = 0;
+   size_t                                   active_workers = 0;
+};
+
 class chain_api_plugin_impl {
 public:
    chain_api_plugin_impl(controller& db)
       : db(db) {}
 
    controller& db;
+
+   uint16_t                                 read_only_threads = 0;
+   fc::microseconds                         read_only_window_time{10000};
+   uint32_t                                 read_only_max_queued = 1000;
+   std::shared_ptr<read_only_executor>      ro_executor;
 };
 
 
 chain_api_plugin::chain_api_plugin(){}
 chain_api_plugin::~chain_api_plugin(){}
 
-void chain_api_plugin::set_program_options(options_description&, options_description&) {}
-void chain_api_plugin::plugin_initialize(const variables_map&) {}
+void chain_api_plugin::set_program_options(options_description&, options_description& cfg) {
+   cfg.add_options()
+         ("read-only-threads", bpo::value<uint16_t>()->default_value(0),
+          "Number of threads serving read only chain api calls. When 0, read only calls run on the main thread. "
+          "Otherwise the main thread periodically pauses between other work and lets this many threads serve the "
+          "queued read only calls in parallel.")
+         ("read-only-window-time-us", bpo::value<uint32_t>()->default_value(10000),
+          "Maximum time in microseconds the main thread pauses for each read only window; calls that have not "
+          "started by then wait for the next window. At most a tenth of the block interval.")
+         ("read-only-max-queued-calls", bpo::value<uint32_t>()->default_value(1000),
+          "Maximum number of read only calls waiting for a read only window; further calls are answered with a 503.")
+         ;
+}
+
+void chain_api_plugin::plugin_initialize(const variables_map& options) {
+   try {
+      my.reset(new chain_api_plugin_impl(app().get_plugin<chain_plugin>().chain()));
+      my->read_only_threads = options.at( "read-only-threads" ).as<uint16_t>();
+      my->read_only_window_time = fc::microseconds( options.at( "read-only-window-time-us" ).as<uint32_t>() );
+      my->read_only_max_queued = options.at( "read-only-max-queued-calls" ).as<uint32_t>();
+      if( my->read_only_threads > 0 ) {
+         EOS_ASSERT( my->read_only_window_time.count() > 0, chain::plugin_config_exception,
+                     "read-only-window-time-us must be greater than 0 when read-only-threads is set" );
+         EOS_ASSERT( my->read_only_window_time.count() <= chain::config::block_interval_us / 10, chain::plugin_config_exception,
+                     "read-only-window-time-us must not exceed ${max}, a tenth of the block interval",
+                     ("max", chain::config::block_interval_us / 10) );
+         EOS_ASSERT( my->read_only_max_queued > 0, chain::plugin_config_exception,
+                     "read-only-max-queued-calls must be greater than 0 when read-only-threads is set" );
+      }
+   } FC_LOG_AND_RETHROW()
+}
 
 struct async_result_visitor : public fc::visitor<fc::variant> {
    template<typename T>
@@ -61,6 +208,21 @@ namespace {
           } \
        }}
 
+// for calls with a call_name_json variant that returns the response as JSON text; expects max_response_time in scope
+#define CALL_JSON(api_name, api_handle, api_namespace, call_name, http_response_code) \
+{std::string("/v1/" #api_name "/" #call_name), \
+   [api_handle, max_response_time](string, string body, url_response_callback cb) mutable { \
+          api_handle.validate(); \
+          try { \
+             if (body.empty()) body = "{}"; \
+             const auto deadline = fc::time_point::now() + max_response_time; \
+             std::string result( api_handle.call_name ## _json(fc::json::from_string(body).as<api_namespace::call_name ## _params>(), deadline) ); \
+             cb.send_json(http_response_code, std::move(result)); \
+          } catch (...) { \
+             http_plugin::handle_exception(#api_name, #call_name, body, cb); \
+          } \
+       }}
+
 #define CALL_WITH_400(api_name, api_handle, api_namespace, call_name, http_response_code) \
 {std::string("/v1/" #api_name "/" #call_name), \
    [api_handle](string, string body, url_response_callback cb) mutable { \
@@ -94,36 +256,66 @@ namespace {
    }\
 }
 
+// for calls taking the fc::raw packed form of their params as the request body
+#define CALL_ASYNC_BINARY(api_name, api_handle, api_namespace, call_name, call_result, http_response_code) \
+{std::string("/v1/" #api_name "/" #call_name), \
+   [api_handle](string, string body, url_response_callback cb) mutable { \
+      api_handle.validate(); \
+      try { \
+         api_namespace::call_name ## _params params; \
+         fc::datastream<const char*> ds( body.data(), body.size() ); \
+         fc::raw::unpack( ds, params ); \
+         EOS_ASSERT( ds.remaining() == 0, chain::invalid_http_request, "Unexpected ${n} bytes after params", ("n", ds.remaining()) ); \
+         api_handle.call_name(std::move(params), \
+            [cb](const fc::static_variant<fc::exception_ptr, call_result>& result){\
+               if (result.contains<fc::exception_ptr>()) {\
+                  try {\
+                     result.get<fc::exception_ptr>()->dynamic_rethrow_exception();\
+                  } catch (...) {\
+                     http_plugin::handle_exception(#api_name, #call_name, "", cb);\
+                  }\
+               } else {\
+                  cb(http_response_code, result.visit(async_result_visitor()));\
+               }\
+            });\
+      } catch (...) { \
+         http_plugin::handle_exception(#api_name, #call_name, "", cb); \
+      } \
+   }\
+}
+
 #define CHAIN_RO_CALL(call_name, http_response_code) CALL(chain, ro_api, chain_apis::read_only, call_name, http_response_code)
+#define CHAIN_RO_CALL_JSON(call_name, http_response_code) CALL_JSON(chain, ro_api, chain_apis::read_only, call_name, http_response_code)
 #define CHAIN_RW_CALL(call_name, http_response_code) CALL(chain, rw_api, chain_apis::read_write, call_name, http_response_code)
 #define CHAIN_RO_CALL_ASYNC(call_name, call_result, http_response_code) CALL_ASYNC(chain, ro_api, chain_apis::read_only, call_name, call_result, http_response_code)
 #define CHAIN_RW_CALL_ASYNC(call_name, call_result, http_response_code) CALL_ASYNC(chain, rw_api, chain_apis::read_write, call_name, call_result, http_response_code)
+#define CHAIN_RW_CALL_ASYNC_BINARY(call_name, call_result, http_response_code) CALL_ASYNC_BINARY(chain, rw_api, chain_apis::read_write, call_name, call_result, http_response_code)
 
 #define CHAIN_RO_CALL_WITH_400(call_name, http_response_code) CALL_WITH_400(chain, ro_api, chain_apis::read_only, call_name, http_response_code)
 
 void chain_api_plugin::plugin_startup() {
    ilog( "starting chain_api_plugin" );
-   my.reset(new chain_api_plugin_impl(app().get_plugin<chain_plugin>().chain()));
    auto& chain = app().get_plugin<chain_plugin>();
    auto ro_api = chain.get_read_only_api();
    auto rw_api = chain.get_read_write_api();
 
    auto& _http_plugin = app().get_plugin<http_plugin>();
    ro_api.set_shorten_abi_errors( !_http_plugin.verbose_errors() );
+   const fc::microseconds max_response_time = _http_plugin.get_max_response_time();
 
    _http_plugin.add_api({
       CHAIN_RO_CALL(get_info, 200)}, appbase::priority::medium_high);
-   _http_plugin.add_api({
+
+   // calls that only read chainbase; block log and fork database reads are not safe off the main thread
+   api_description read_only_calls = {
       CHAIN_RO_CALL(get_activated_protocol_features, 200),
-      CHAIN_RO_CALL(get_block, 200),
-      CHAIN_RO_CALL(get_block_header_state, 200),
       CHAIN_RO_CALL(get_account, 200),
       CHAIN_RO_CALL(get_code, 200),
       CHAIN_RO_CALL(get_code_hash, 200),
       CHAIN_RO_CALL(get_abi, 200),
       CHAIN_RO_CALL(get_raw_code_and_abi, 200),
       CHAIN_RO_CALL(get_raw_abi, 200),
-      CHAIN_RO_CALL(get_table_rows, 200),
+      CHAIN_RO_CALL_JSON(get_table_rows, 200),
       CHAIN_RO_CALL(get_table_by_scope, 200),
       CHAIN_RO_CALL(get_currency_balance, 200),
       CHAIN_RO_CALL(get_currency_stats, 200),
@@ -133,11 +325,29 @@ void chain_api_plugin::plugin_startup() {
       CHAIN_RO_CALL(abi_json_to_bin, 200),
       CHAIN_RO_CALL(abi_bin_to_json, 200),
       CHAIN_RO_CALL(get_required_keys, 200),
-      CHAIN_RO_CALL(get_transaction_id, 200),
+      CHAIN_RO_CALL(get_transaction_id, 200)
+   };
+
+   if( my->read_only_threads > 0 ) {
+      ilog( "serving read only chain api calls on ${n} threads", ("n", my->read_only_threads) );
+      my->ro_executor = std::make_shared<read_only_executor>( my->read_only_threads, my->read_only_window_time,
+                                                              my->read_only_max_queued, appbase::priority::medium_low );
+      _http_plugin.add_executor_api( read_only_calls, [ro_executor = my->ro_executor]( std::function<void()> task ) {
+         return ro_executor->post( std::move( task ) );
+      } );
+   } else {
+      _http_plugin.add_api( read_only_calls );
+   }
+
+   _http_plugin.add_api({
+      CHAIN_RO_CALL(get_block, 200),
+      CHAIN_RO_CALL(get_block_header_state, 200),
       CHAIN_RW_CALL_ASYNC(push_block, chain_apis::read_write::push_block_results, 202),
       CHAIN_RW_CALL_ASYNC(push_transaction, chain_apis::read_write::push_transaction_results, 202),
       CHAIN_RW_CALL_ASYNC(push_transactions, chain_apis::read_write::push_transactions_results, 202),
-      CHAIN_RW_CALL_ASYNC(send_transaction, chain_apis::read_write::send_transaction_results, 202)
+      CHAIN_RW_CALL_ASYNC_BINARY(push_packed_transactions, chain_apis::read_write::push_packed_transactions_results, 202),
+      CHAIN_RW_CALL_ASYNC(send_transaction, chain_apis::read_write::send_transaction_results, 202),
+      CHAIN_RW_CALL_ASYNC_BINARY(send_transaction_binary, chain_apis::read_write::send_transaction_binary_results, 202)
    });
 
    if (chain.account_queries_enabled()) {
@@ -147,6 +357,9 @@ void chain_api_plugin::plugin_startup() {
    }
 }
 
-void chain_api_plugin::plugin_shutdown() {}
+void chain_api_plugin::plugin_shutdown() {
+   if( my && my->ro_executor )
+      my->ro_executor->stop();
+}
 
 }
@@ -7,7 +7,7 @@
 #include <eosio/chain/config.hpp>
 #include <eosio/chain/wasm_interface.hpp>
 #include <eosio/chain/resource_limits.hpp>
-#include <eosio/chain/reversible_block_object.hpp>
+#include <eosio/chain/reversible_block_log.hpp>
 #include <eosio/chain/controller.hpp>
 #include <eosio/chain/generated_transaction_object.hpp>
 #include <eosio/chain/global_property_object.hpp>
@@ -246,8 +246,8 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
           "Override default maximum ABI serialization time allowed in ms")
          ("chain-state-db-size-mb", bpo::value<uint64_t>()->default_value(config::default_state_size / (1024  * 1024)), "Maximum size (in MiB) of the chain state database")
          ("chain-state-db-guard-size-mb", bpo::value<uint64_t>()->default_value(config::default_state_guard_size / (1024  * 1024)), "Safely shut down node when free space remaining in the chain state database drops below this size (in MiB).")
-         ("reversible-blocks-db-size-mb", bpo::value<uint64_t>()->default_value(config::default_reversible_cache_size / (1024  * 1024)), "Maximum size (in MiB) of the reversible blocks database")
-         ("reversible-blocks-db-guard-size-mb", bpo::value<uint64_t>()->default_value(config::default_reversible_guard_size / (1024  * 1024)), "Safely shut down node when free space remaining in the reverseible blocks database drops below this size (in MiB).")
+         ("reversible-blocks-db-size-mb", bpo::value<uint64_t>(), "Deprecated and ignored, reversible blocks are kept in an append only log")
+         ("reversible-blocks-db-guard-size-mb", bpo::value<uint64_t>(), "Deprecated and ignored, reversible blocks are kept in an append only log")
          ("signature-cpu-billable-pct", bpo::value<uint32_t>()->default_value(config::default_sig_cpu_bill_pct / config::percent_1),
           "Percentage of actual signature recovery cpu to bill. Whole number percentages, e.g. 50 for 50%")
          ("chain-threads", bpo::value<uint16_t>()->default_value(config::default_controller_thread_pool_size),
@@ -334,7 +334,7 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
          ("extract-build-info", bpo::value<bfs::path>(),
           "extract build environment information as JSON, write into specified file, and exit")
          ("fix-reversible-blocks", bpo::bool_switch()->default_value(false),
-          "recovers reversible block database if that database is in a bad state")
+          "recovers reversible block log if that log is in a bad state")
          ("force-all-checks", bpo::bool_switch()->default_value(false),
           "do not skip any checks that can be skipped while replaying irreversible blocks")
          ("disable-replay-opts", bpo::bool_switch()->default_value(false),
@@ -610,16 +610,9 @@ chain_plugin::do_hard_replay(const variables_map& options) {
          if( fc::exists( backup_dir / config::reversible_blocks_dir_name ) ||
              options.at( "fix-reversible-blocks" ).as<bool>()) {
             // Do not try to recover reversible blocks if the directory does not exist, unless the option was explicitly provided.
-            if( !recover_reversible_blocks( backup_dir / config::reversible_blocks_dir_name,
-                                            my->chain_config->reversible_cache_size,
-                                            my->chain_config->blocks_dir / config::reversible_blocks_dir_name,
-                                            options.at( "truncate-at-block" ).as<uint32_t>())) {
-               ilog( "Reversible blocks database was not corrupted. Copying from backup to blocks directory." );
-               fc::copy( backup_dir / config::reversible_blocks_dir_name,
-                         my->chain_config->blocks_dir / config::reversible_blocks_dir_name );
-               fc::copy( backup_dir / config::reversible_blocks_dir_name / "shared_memory.bin",
-                         my->chain_config->blocks_dir / config::reversible_blocks_dir_name / "shared_memory.bin" );
-            }
+            recover_reversible_blocks( backup_dir / config::reversible_blocks_dir_name,
+                                       my->chain_config->blocks_dir / config::reversible_blocks_dir_name,
+                                       options.at( "truncate-at-block" ).as<uint32_t>());
          }
 }
 
@@ -741,12 +734,8 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
       if( options.count( "chain-state-db-guard-size-mb" ))
          my->chain_config->state_guard_size = options.at( "chain-state-db-guard-size-mb" ).as<uint64_t>() * 1024 * 1024;
 
-      if( options.count( "reversible-blocks-db-size-mb" ))
-         my->chain_config->reversible_cache_size =
-               options.at( "reversible-blocks-db-size-mb" ).as<uint64_t>() * 1024 * 1024;
-
-      if( options.count( "reversible-blocks-db-guard-size-mb" ))
-         my->chain_config->reversible_guard_size = options.at( "reversible-blocks-db-guard-size-mb" ).as<uint64_t>() * 1024 * 1024;
+      if( options.count( "reversible-blocks-db-size-mb" ) || options.count( "reversible-blocks-db-guard-size-mb" ))
+         wlog( "reversible-blocks-db-size-mb and reversible-blocks-db-guard-size-mb are deprecated and ignored" );
 
       if( options.count( "chain-threads" )) {
          my->chain_config->thread_pool_size = options.at( "chain-threads" ).as<uint16_t>();
@@ -836,14 +825,12 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
             wlog( "The --truncate-at-block option does not work for a regular replay of the blockchain." );
          clear_chainbase_files( my->chain_config->state_dir );
          if( options.at( "fix-reversible-blocks" ).as<bool>()) {
-            if( !recover_reversible_blocks( my->chain_config->blocks_dir / config::reversible_blocks_dir_name,
-                                            my->chain_config->reversible_cache_size )) {
+            if( !recover_reversible_blocks( my->chain_config->blocks_dir / config::reversible_blocks_dir_name )) {
                ilog( "Reversible blocks database was not corrupted." );
             }
          }
       } else if( options.at( "fix-reversible-blocks" ).as<bool>()) {
          if( !recover_reversible_blocks( my->chain_config->blocks_dir / config::reversible_blocks_dir_name,
-                                         my->chain_config->reversible_cache_size,
                                          optional<fc::path>(),
                                          options.at( "truncate-at-block" ).as<uint32_t>())) {
             ilog( "Reversible blocks database verified to not be corrupted. Now exiting..." );
@@ -858,8 +845,7 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
          ilog("Importing reversible blocks from '${file}'", ("file", reversible_blocks_file.generic_string()) );
          fc::remove_all( my->chain_config->blocks_dir/config::reversible_blocks_dir_name );
 
-         import_reversible_blocks( my->chain_config->blocks_dir/config::reversible_blocks_dir_name,
-                                   my->chain_config->reversible_cache_size, reversible_blocks_file );
+         import_reversible_blocks( my->chain_config->blocks_dir/config::reversible_blocks_dir_name, reversible_blocks_file );
 
          EOS_THROW( node_management_success, "imported reversible blocks" );
       }
@@ -1225,108 +1211,39 @@ bool chain_plugin::block_is_on_preferred_chain(const block_id_type& block_id) {
    return b && b->id() == block_id;
 }
 
-bool chain_plugin::recover_reversible_blocks( const fc::path& db_dir, uint32_t cache_size,
-                                              optional<fc::path> new_db_dir, uint32_t truncate_at_block ) {
-   try {
-      chainbase::database reversible( db_dir, database::read_only); // Test if dirty
-      // If it reaches here, then the reversible database is not dirty
+bool chain_plugin::recover_reversible_blocks( const fc::path& reversible_dir,
+                                              optional<fc::path> new_reversible_dir, uint32_t truncate_at_block ) {
+   // opening the log drops any partially written blocks at its end
+   reversible_block_log reversible( reversible_dir );
 
-      if( truncate_at_block == 0 )
+   if( !new_reversible_dir ) {
+      if( truncate_at_block == 0 || reversible.empty() || reversible.last_block_num() <= truncate_at_block )
          return false;
-
-      reversible.add_index<reversible_block_index>();
-      const auto& ubi = reversible.get_index<reversible_block_index,by_num>();
-
-      auto itr = ubi.rbegin();
-      if( itr != ubi.rend() && itr->blocknum <= truncate_at_block )
-         return false; // Because we are not going to be truncating the reversible database at all.
-   } catch( const std::runtime_error& ) {
-   } catch( ... ) {
-      throw;
-   }
-   // Reversible block database is dirty (or incompatible). So back it up (unless already moved) and then create a new one.
-
-   auto reversible_dir = fc::canonical( db_dir );
-   if( reversible_dir.filename().generic_string() == "." ) {
-      reversible_dir = reversible_dir.parent_path();
-   }
-   fc::path backup_dir;
-
-   auto now = fc::time_point::now();
-
-   if( new_db_dir ) {
-      backup_dir = reversible_dir;
-      reversible_dir = *new_db_dir;
-   } else {
-      auto reversible_dir_name = reversible_dir.filename().generic_string();
-      EOS_ASSERT( reversible_dir_name != ".", invalid_reversible_blocks_dir, "Invalid path to reversible directory" );
-      backup_dir = reversible_dir.parent_path() / reversible_dir_name.append("-").append( now );
-
-      EOS_ASSERT( !fc::exists(backup_dir),
-                  reversible_blocks_backup_dir_exist,
-                 "Cannot move existing reversible directory to already existing directory '${backup_dir}'",
-                 ("backup_dir", backup_dir) );
-
-      fc::rename( reversible_dir, backup_dir );
-      ilog( "Moved existing reversible directory to backup location: '${new_db_dir}'", ("new_db_dir", backup_dir) );
-   }
-
-   fc::create_directories( reversible_dir );
-
-   ilog( "Reconstructing '${reversible_dir}' from backed up reversible directory", ("reversible_dir", reversible_dir) );
-
-   optional<chainbase::database> old_reversible;
-
-   try {
-      old_reversible = chainbase::database( backup_dir, database::read_only, 0, true );
-   } catch (const std::runtime_error &) {
-      // since we are allowing for dirty, it must be incompatible
-      ilog( "Did not recover any reversible blocks since reversible database incompatible");
+      reversible.remove_from( truncate_at_block + 1 );
+      ilog( "Truncated reversible blocks at specified block number: ${stop}", ("stop", truncate_at_block) );
       return true;
    }
 
-   chainbase::database  new_reversible( reversible_dir, database::read_write, cache_size );
-   std::fstream         reversible_blocks;
-   reversible_blocks.open( (reversible_dir.parent_path() / std::string("portable-reversible-blocks-").append( now ) ).generic_string().c_str(),
-                           std::ios::out | std::ios::binary );
+   ilog( "Reconstructing '${reversible_dir}' from backed up reversible directory", ("reversible_dir", *new_reversible_dir) );
+   fc::remove_all( *new_reversible_dir );
+   reversible_block_log new_reversible( *new_reversible_dir );
 
    uint32_t num = 0;
-   uint32_t start = 0;
-   uint32_t end = 0;
-   old_reversible->add_index<reversible_block_index>();
-   new_reversible.add_index<reversible_block_index>();
-   const auto& ubi = old_reversible->get_index<reversible_block_index,by_num>();
-   auto itr = ubi.begin();
-   if( itr != ubi.end() ) {
-      start = itr->blocknum;
-      end = start - 1;
-   }
-   if( truncate_at_block > 0 && start > truncate_at_block ) {
+   const uint32_t start = reversible.first_block_num();
+   uint32_t end = start - 1;
+   if( !reversible.empty() && truncate_at_block > 0 && start > truncate_at_block ) {
       ilog( "Did not recover any reversible blocks since the specified block number to stop at (${stop}) is less than first block in the reversible database (${start}).", ("stop", truncate_at_block)("start", start) );
       return true;
    }
-   try {
-      for( ; itr != ubi.end(); ++itr ) {
-         EOS_ASSERT( itr->blocknum == end + 1, gap_in_reversible_blocks_db,
-                     "gap in reversible block database between ${end} and ${blocknum}",
-                     ("end", end)("blocknum", itr->blocknum)
-                   );
-         reversible_blocks.write( itr->packedblock.data(), itr->packedblock.size() );
-         new_reversible.create<reversible_block_object>( [&]( auto& ubo ) {
-            ubo.blocknum = itr->blocknum;
-            ubo.set_block( itr->get_block() ); // get_block and set_block rather than copying the packed data acts as additional validation
-         });
-         end = itr->blocknum;
-         ++num;
-         if( end == truncate_at_block )
-            break;
+   for( uint32_t n = start; !reversible.empty() && n <= reversible.last_block_num(); ++n ) {
+      new_reversible.append( reversible.read_block( n ) );
+      end = n;
+      ++num;
+      if( end == truncate_at_block ) {
+         ilog( "Stopped recovery of reversible blocks early at specified block number: ${stop}", ("stop", truncate_at_block) );
+         break;
       }
-   } catch( const gap_in_reversible_blocks_db& e ) {
-      wlog( "${details}", ("details", e.to_detail_string()) );
-   } catch( ... ) {}
-
-   if( end == truncate_at_block )
-      ilog( "Stopped recovery of reversible blocks early at specified block number: ${stop}", ("stop", truncate_at_block) );
+   }
 
    if( num == 0 )
       ilog( "There were no recoverable blocks in the reversible block database" );
@@ -1340,10 +1257,9 @@ bool chain_plugin::recover_reversible_blocks( const fc::path& db_dir, uint32_t c
 }
 
 bool chain_plugin::import_reversible_blocks( const fc::path& reversible_dir,
-                                             uint32_t cache_size,
                                              const fc::path& reversible_blocks_file ) {
    std::fstream         reversible_blocks;
-   chainbase::database  new_reversible( reversible_dir, database::read_write, cache_size );
+   reversible_block_log new_reversible( reversible_dir );
    reversible_blocks.open( reversible_blocks_file.generic_string().c_str(), std::ios::in | std::ios::binary );
 
    reversible_blocks.seekg( 0, std::ios::end );
@@ -1353,12 +1269,11 @@ bool chain_plugin::import_reversible_blocks( const fc::path& reversible_dir,
    uint32_t num = 0;
    uint32_t start = 0;
    uint32_t end = 0;
-   new_reversible.add_index<reversible_block_index>();
    try {
       while( reversible_blocks.tellg() < end_pos ) {
-         signed_block tmp;
-         fc::raw::unpack(reversible_blocks, tmp);
-         num = tmp.block_num();
+         auto tmp = std::make_shared<signed_block>();
+         fc::raw::unpack(reversible_blocks, *tmp);
+         num = tmp->block_num();
 
          if( start == 0 ) {
             start = num;
@@ -1369,10 +1284,7 @@ bool chain_plugin::import_reversible_blocks( const fc::path& reversible_dir,
                       );
          }
 
-         new_reversible.create<reversible_block_object>( [&]( auto& ubo ) {
-            ubo.blocknum = num;
-            ubo.set_block( std::make_shared<signed_block>(std::move(tmp)) );
-         });
+         new_reversible.append( tmp );
          end = num;
       }
    } catch( gap_in_reversible_blocks_db& e ) {
@@ -1390,35 +1302,19 @@ bool chain_plugin::import_reversible_blocks( const fc::path& reversible_dir,
 
 bool chain_plugin::export_reversible_blocks( const fc::path& reversible_dir,
                                              const fc::path& reversible_blocks_file ) {
-   chainbase::database  reversible( reversible_dir, database::read_only, 0, true );
+   reversible_block_log reversible( reversible_dir, reversible_block_log::open_mode::read_only );
    std::fstream         reversible_blocks;
    reversible_blocks.open( reversible_blocks_file.generic_string().c_str(), std::ios::out | std::ios::binary );
 
    uint32_t num = 0;
-   uint32_t start = 0;
-   uint32_t end = 0;
-   reversible.add_index<reversible_block_index>();
-   const auto& ubi = reversible.get_index<reversible_block_index,by_num>();
-   auto itr = ubi.begin();
-   if( itr != ubi.end() ) {
-      start = itr->blocknum;
-      end = start - 1;
-   }
+   uint32_t start = reversible.first_block_num();
+   uint32_t end = start - 1;
    try {
-      for( ; itr != ubi.end(); ++itr ) {
-         EOS_ASSERT( itr->blocknum == end + 1, gap_in_reversible_blocks_db,
-                     "gap in reversible block database between ${end} and ${blocknum}",
-                     ("end", end)("blocknum", itr->blocknum)
-                   );
-         signed_block tmp;
-         fc::datastream<const char *> ds( itr->packedblock.data(), itr->packedblock.size() );
-         fc::raw::unpack(ds, tmp); // Verify that packed block has not been corrupted.
-         reversible_blocks.write( itr->packedblock.data(), itr->packedblock.size() );
-         end = itr->blocknum;
-         ++num;
+      for( ; !reversible.empty() && end != reversible.last_block_num(); ++end, ++num ) {
+         auto b = reversible.read_block( end + 1 ); // unpacking verifies that the stored block has not been corrupted
+         auto packed = fc::raw::pack( *b );
+         reversible_blocks.write( packed.data(), packed.size() );
       }
-   } catch( const gap_in_reversible_blocks_db& e ) {
-      wlog( "${details}", ("details", e.to_detail_string()) );
    } catch( ... ) {}
 
    if( num == 0 ) {
@@ -1462,9 +1358,6 @@ void chain_plugin::log_guard_exception(const chain::guard_exception&e ) {
    if (e.code() == chain::database_guard_exception::code_value) {
       elog("Database has reached an unsafe level of usage, shutting down to avoid corrupting the database.  "
            "Please increase the value set for \"chain-state-db-size-mb\" and restart the process!");
-   } else if (e.code() == chain::reversible_guard_exception::code_value) {
-      elog("Reversible block database has reached an unsafe level of usage, shutting down to avoid corrupting the database.  "
-           "Please increase the value set for \"reversible-blocks-db-size-mb\" and restart the process!");
    }
 
    dlog("Details: ${details}", ("details", e.to_detail_string()));
@@ -1479,7 +1372,7 @@ void chain_plugin::handle_guard_exception(const chain::guard_exception& e) {
 }
 
 void chain_plugin::handle_db_exhaustion() {
-   elog("database memory exhausted: increase chain-state-db-size-mb and/or reversible-blocks-db-size-mb");
+   elog("database memory exhausted: increase chain-state-db-size-mb");
    //return 1 -- it's what programs/nodeos/main.cpp considers "BAD_ALLOC"
    std::_Exit(1);
 }
@@ -1743,7 +1636,42 @@ string get_table_type( const abi_def& abi, const name& table_name ) {
    EOS_ASSERT( false, chain::contract_table_query_exception, "Table ${table} is not specified in the ABI", ("table",table_name) );
 }
 
-read_only::get_table_rows_result read_only::get_table_rows( const read_only::get_table_rows_params& p )const {
+void read_only::append_table_row( get_table_rows_result& result, const abi_serializer& abis, const get_table_rows_params& p,
+                                  const vector<char>& data, name payer )const {
+   fc::variant data_var;
+   if( p.json ) {
+      data_var = abis.binary_to_variant( abis.get_table_type(p.table), data, abi_serializer::create_yield_function( abi_serializer_max_time ), shorten_abi_errors );
+   } else {
+      data_var = fc::variant( data );
+   }
+
+   if( p.show_payer && *p.show_payer ) {
+      result.rows.emplace_back( fc::mutable_variant_object("data", std::move(data_var))("payer", payer) );
+   } else {
+      result.rows.emplace_back( std::move(data_var) );
+   }
+}
+
+void read_only::append_table_row( get_table_rows_json_result& result, const abi_serializer& abis, const get_table_rows_params& p,
+                                  const vector<char>& data, name payer )const {
+   // same text fc::json gives the variant built by the overload above
+   if( !result.rows.empty() ) result.rows += ',';
+   const bool show_payer = p.show_payer && *p.show_payer;
+   if( show_payer ) result.rows += "{\"data\":";
+   if( p.json ) {
+      abis.binary_to_json( abis.get_table_type(p.table), data, result.rows, abi_serializer::create_yield_function( abi_serializer_max_time ), shorten_abi_errors );
+   } else {
+      result.rows += fc::json::to_string( fc::variant( data ), fc::time_point::maximum() );
+   }
+   if( show_payer ) {
+      result.rows += ",\"payer\":\"";
+      result.rows += payer.to_string();
+      result.rows += "\"}";
+   }
+}
+
+template <typename Result>
+Result read_only::get_table_rows_as( const read_only::get_table_rows_params& p )const {
    const abi_def abi = eosio::chain_apis::get_abi( db, p.code );
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstrict-aliasing"
@@ -1753,43 +1681,43 @@ read_only::get_table_rows_result read_only::get_table_rows( const read_only::get
       EOS_ASSERT( p.table == table_with_index, chain::contract_table_query_exception, "Invalid table name ${t}", ( "t", p.table ));
       auto table_type = get_table_type( abi, p.table );
       if( table_type == KEYi64 || p.key_type == "i64" || p.key_type == "name" ) {
-         return get_table_rows_ex<key_value_index>(p,abi);
+         return get_table_rows_ex<key_value_index, Result>(p,abi);
       }
       EOS_ASSERT( false, chain::contract_table_query_exception,  "Invalid table type ${type}", ("type",table_type)("abi",abi));
    } else {
       EOS_ASSERT( !p.key_type.empty(), chain::contract_table_query_exception, "key type required for non-primary index" );
 
       if (p.key_type == chain_apis::i64 || p.key_type == "name") {
-         return get_table_rows_by_seckey<index64_index, uint64_t>(p, abi, [](uint64_t v)->uint64_t {
+         return get_table_rows_by_seckey<index64_index, uint64_t, Result>(p, abi, [](uint64_t v)->uint64_t {
             return v;
          });
       }
       else if (p.key_type == chain_apis::i128) {
-         return get_table_rows_by_seckey<index128_index, uint128_t>(p, abi, [](uint128_t v)->uint128_t {
+         return get_table_rows_by_seckey<index128_index, uint128_t, Result>(p, abi, [](uint128_t v)->uint128_t {
             return v;
          });
       }
       else if (p.key_type == chain_apis::i256) {
          if ( p.encode_type == chain_apis::hex) {
             using  conv = keytype_converter<chain_apis::sha256,chain_apis::hex>;
-            return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, abi, conv::function());
+            return get_table_rows_by_seckey<conv::index_type, conv::input_type, Result>(p, abi, conv::function());
          }
          using  conv = keytype_converter<chain_apis::i256>;
-         return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, abi, conv::function());
+         return get_table_rows_by_seckey<conv::index_type, conv::input_type, Result>(p, abi, conv::function());
       }
       else if (p.key_type == chain_apis::float64) {
-         return get_table_rows_by_seckey<index_double_index, double>(p, abi, [](double v)->float64_t {
+         return get_table_rows_by_seckey<index_double_index, double, Result>(p, abi, [](double v)->float64_t {
             float64_t f = *(float64_t *)&v;
             return f;
          });
       }
       else if (p.key_type == chain_apis::float128) {
          if ( p.encode_type == chain_apis::hex) {
-            return get_table_rows_by_seckey<index_long_double_index, uint128_t>(p, abi, [](uint128_t v)->float128_t{
+            return get_table_rows_by_seckey<index_long_double_index, uint128_t, Result>(p, abi, [](uint128_t v)->float128_t{
                return *reinterpret_cast<float128_t *>(&v);
             });
          }
-         return get_table_rows_by_seckey<index_long_double_index, double>(p, abi, [](double v)->float128_t{
+         return get_table_rows_by_seckey<index_long_double_index, double, Result>(p, abi, [](double v)->float128_t{
             float64_t f = *(float64_t *)&v;
             float128_t f128;
             f64_to_f128M(f, &f128);
@@ -1798,17 +1726,36 @@ read_only::get_table_rows_result read_only::get_table_rows( const read_only::get
       }
       else if (p.key_type == chain_apis::sha256) {
          using  conv = keytype_converter<chain_apis::sha256,chain_apis::hex>;
-         return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, abi, conv::function());
+         return get_table_rows_by_seckey<conv::index_type, conv::input_type, Result>(p, abi, conv::function());
       }
       else if(p.key_type == chain_apis::ripemd160) {
          using  conv = keytype_converter<chain_apis::ripemd160,chain_apis::hex>;
-         return get_table_rows_by_seckey<conv::index_type, conv::input_type>(p, abi, conv::function());
+         return get_table_rows_by_seckey<conv::index_type, conv::input_type, Result>(p, abi, conv::function());
       }
       EOS_ASSERT(false, chain::contract_table_query_exception,  "Unsupported secondary index type: ${t}", ("t", p.key_type));
    }
 #pragma GCC diagnostic pop
 }
 
+read_only::get_table_rows_result read_only::get_table_rows( const read_only::get_table_rows_params& p )const {
+   return get_table_rows_as<get_table_rows_result>( p );
+}
+
+string read_only::get_table_rows_json( const read_only::get_table_rows_params& p, const fc::time_point& deadline )const {
+   auto result = get_table_rows_as<get_table_rows_json_result>( p );
+   FC_CHECK_DEADLINE( deadline );
+   string json;
+   json.reserve( result.rows.size() + result.next_key.size() + 48 );
+   json += "{\"rows\":[";
+   json += result.rows;
+   json += "],\"more\":";
+   json += result.more ? "true" : "false";
+   json += ",\"next_key\":";
+   json += fc::json::to_string( fc::variant( result.next_key ), fc::time_point::maximum() );
+   json += '}';
+   return json;
+}
+
 read_only::get_table_by_scope_result read_only::get_table_by_scope( const read_only::get_table_by_scope_params& p )const {
    read_only::get_table_by_scope_result result;
    const auto& d = db.db();
@@ -2291,6 +2238,56 @@ void read_write::push_transactions(const read_write::push_transactions_params& p
    } CATCH_AND_CALL(next);
 }
 
+void read_write::push_packed_transactions(read_write::push_packed_transactions_params&& params, next_function<read_write::push_packed_transactions_results> next) {
+   try {
+      EOS_ASSERT( params.size() <= 1000, too_many_tx_at_once, "Attempt to push too many transactions at once" );
+      if( params.empty() ) {
+         next( read_write::push_packed_transactions_results{} );
+         return;
+      }
+
+      // callbacks of transaction_async are all called on the main thread
+      struct batch {
+         read_write::push_packed_transactions_results results;
+         size_t                                       remaining = 0;
+         next_function<read_write::push_packed_transactions_results> next;
+      };
+      auto b = std::make_shared<batch>();
+      b->results.resize( params.size() );
+      b->remaining = params.size();
+      b->next = next;
+
+      for( size_t i = 0; i < params.size(); ++i ) {
+         auto trx = std::make_shared<packed_transaction>( std::move( params[i] ) );
+         auto complete = [this, b, i, id = trx->id()](const fc::static_variant<fc::exception_ptr, transaction_trace_ptr>& result) -> void {
+            auto& r = b->results[i];
+            if( result.contains<fc::exception_ptr>() ) {
+               r = read_write::push_transaction_results{ id, fc::mutable_variant_object( "error", result.get<fc::exception_ptr>()->to_detail_string() ) };
+            } else {
+               const auto& trx_trace_ptr = result.get<transaction_trace_ptr>();
+               try {
+                  r = read_write::push_transaction_results{ id, db.to_variant_with_abi( *trx_trace_ptr, abi_serializer::create_yield_function( abi_serializer_max_time ) ) };
+               } catch( chain::abi_exception& ) {
+                  r = read_write::push_transaction_results{ id, fc::variant( *trx_trace_ptr ) };
+               }
+            }
+            if( --b->remaining == 0 ) {
+               b->next( std::move( b->results ) );
+            }
+         };
+         try {
+            app().get_method<incoming::methods::transaction_async>()(trx, true, complete);
+         } catch( const fc::exception& e ) {
+            complete( e.dynamic_copy_exception() );
+         }
+      }
+   } catch ( boost::interprocess::bad_alloc& ) {
+      chain_plugin::handle_db_exhaustion();
+   } catch ( const std::bad_alloc& ) {
+      chain_plugin::handle_bad_alloc();
+   } CATCH_AND_CALL(next);
+}
+
 void read_write::send_transaction(const read_write::send_transaction_params& params, next_function<read_write::send_transaction_results> next) {
 
    try {
@@ -2327,6 +2324,26 @@ void read_write::send_transaction(const read_write::send_transaction_params& par
    } CATCH_AND_CALL(next);
 }
 
+void read_write::send_transaction_binary(read_write::send_transaction_binary_params&& params, next_function<read_write::send_transaction_binary_results> next) {
+   try {
+      auto trx = std::make_shared<packed_transaction>( std::move( params ) );
+
+      app().get_method<incoming::methods::transaction_async>()(trx, true,
+            [next](const fc::static_variant<fc::exception_ptr, transaction_trace_ptr>& result) -> void {
+         if (result.contains<fc::exception_ptr>()) {
+            next(result.get<fc::exception_ptr>());
+         } else {
+            const auto& trace = result.get<transaction_trace_ptr>();
+            next(read_write::send_transaction_binary_results{trace->id, trace->block_num, trace->receipt, trace->elapsed});
+         }
+      });
+   } catch ( boost::interprocess::bad_alloc& ) {
+      chain_plugin::handle_db_exhaustion();
+   } catch ( const std::bad_alloc& ) {
+      chain_plugin::handle_bad_alloc();
+   } CATCH_AND_CALL(next);
+}
+
 read_only::get_abi_results read_only::get_abi( const get_abi_params& params )const {
    get_abi_results result;
    result.account_name = params.account_name;
@@ -313,6 +313,17 @@ public:
 
    get_table_rows_result get_table_rows( const get_table_rows_params& params )const;
 
+   /// rows of a get_table_rows walk written as JSON text straight from their packed form
+   struct get_table_rows_json_result {
+      string              rows; ///< comma separated JSON rows
+      bool                more = false;
+      string              next_key;
+   };
+
+   /// @return the JSON text of get_table_rows( params ), without building an fc::variant per row
+   /// @param deadline - writing the rows is held to this, as serializing a variant response is to http-max-response-time
+   string get_table_rows_json( const get_table_rows_params& params, const fc::time_point& deadline = fc::time_point::maximum() )const;
+
    struct get_table_by_scope_params {
       name        code; // mandatory
       name        table; // optional, act as filter
@@ -421,9 +432,18 @@ public:
 
    static uint64_t get_table_index_name(const read_only::get_table_rows_params& p, bool& primary);
 
-   template <typename IndexType, typename SecKeyType, typename ConvFn>
-   read_only::get_table_rows_result get_table_rows_by_seckey( const read_only::get_table_rows_params& p, const abi_def& abi, ConvFn conv )const {
-      read_only::get_table_rows_result result;
+   void append_table_row( get_table_rows_result& result, const abi_serializer& abis, const get_table_rows_params& p,
+                          const vector<char>& data, name payer )const;
+   void append_table_row( get_table_rows_json_result& result, const abi_serializer& abis, const get_table_rows_params& p,
+                          const vector<char>& data, name payer )const;
+
+   /// dispatches to get_table_rows_ex or get_table_rows_by_seckey for the requested index, collecting rows into a Result
+   template <typename Result>
+   Result get_table_rows_as( const get_table_rows_params& p )const;
+
+   template <typename IndexType, typename SecKeyType, typename Result = read_only::get_table_rows_result, typename ConvFn>
+   Result get_table_rows_by_seckey( const read_only::get_table_rows_params& p, const abi_def& abi, ConvFn conv )const {
+      Result result;
       const auto& d = db.db();
 
       name scope{ convert_to_type<uint64_t>(p.scope, "scope") };
@@ -479,19 +499,7 @@ public:
                const auto* itr2 = d.find<chain::key_value_object, chain::by_scope_primary>( boost::make_tuple(t_id->id, itr->primary_key) );
                if( itr2 == nullptr ) continue;
                copy_inline_row(*itr2, data);
-
-               fc::variant data_var;
-               if( p.json ) {
-                  data_var = abis.binary_to_variant( abis.get_table_type(p.table), data, abi_serializer::create_yield_function( abi_serializer_max_time ), shorten_abi_errors );
-               } else {
-                  data_var = fc::variant( data );
-               }
-
-               if( p.show_payer && *p.show_payer ) {
-                  result.rows.emplace_back( fc::mutable_variant_object("data", std::move(data_var))("payer", itr->payer) );
-               } else {
-                  result.rows.emplace_back( std::move(data_var) );
-               }
+               append_table_row( result, abis, p, data, itr->payer );
 
                ++count;
             }
@@ -512,9 +520,9 @@ public:
       return result;
    }
 
-   template <typename IndexType>
-   read_only::get_table_rows_result get_table_rows_ex( const read_only::get_table_rows_params& p, const abi_def& abi )const {
-      read_only::get_table_rows_result result;
+   template <typename IndexType, typename Result = read_only::get_table_rows_result>
+   Result get_table_rows_ex( const read_only::get_table_rows_params& p, const abi_def& abi )const {
+      Result result;
       const auto& d = db.db();
 
       uint64_t scope = convert_to_type<uint64_t>(p.scope, "scope");
@@ -556,19 +564,7 @@ public:
             vector<char> data;
             for( unsigned int count = 0; cur_time <= end_time && count < p.limit && itr != end_itr; ++count, ++itr, cur_time = fc::time_point::now() ) {
                copy_inline_row(*itr, data);
-
-               fc::variant data_var;
-               if( p.json ) {
-                  data_var = abis.binary_to_variant( abis.get_table_type(p.table), data, abi_serializer::create_yield_function( abi_serializer_max_time ), shorten_abi_errors );
-               } else {
-                  data_var = fc::variant( data );
-               }
-
-               if( p.show_payer && *p.show_payer ) {
-                  result.rows.emplace_back( fc::mutable_variant_object("data", std::move(data_var))("payer", itr->payer) );
-               } else {
-                  result.rows.emplace_back( std::move(data_var) );
-               }
+               append_table_row( result, abis, p, data, itr->payer );
             }
             if( itr != end_itr ) {
                result.more = true;
@@ -620,10 +616,27 @@ public:
    using push_transactions_results = vector<push_transaction_results>;
    void push_transactions(const push_transactions_params& params, chain::plugin_interface::next_function<push_transactions_results> next);
 
+   /// takes the fc::raw packed vector as the request body and submits the whole batch at once so that keys of all
+   /// transactions are recovered in parallel, results are reported in the order of params once every transaction
+   /// has completed
+   using push_packed_transactions_params  = vector<chain::packed_transaction>;
+   using push_packed_transactions_results = push_transactions_results;
+   void push_packed_transactions(push_packed_transactions_params&& params, chain::plugin_interface::next_function<push_packed_transactions_results> next);
+
    using send_transaction_params = push_transaction_params;
    using send_transaction_results = push_transaction_results;
    void send_transaction(const send_transaction_params& params, chain::plugin_interface::next_function<send_transaction_results> next);
 
+   /// takes a packed_transaction in its binary form, reports only the outcome rather than the full trace
+   using send_transaction_binary_params = chain::packed_transaction;
+   struct send_transaction_binary_results {
+      chain::transaction_id_type                          transaction_id;
+      uint32_t                                            block_num = 0;
+      fc::optional<chain::transaction_receipt_header>     receipt;
+      fc::microseconds                                    elapsed;
+   };
+   void send_transaction_binary(send_transaction_binary_params&& params, chain::plugin_interface::next_function<send_transaction_binary_results> next);
+
    friend resolver_factory<read_write>;
 };
 
@@ -719,14 +732,12 @@ public:
 
    bool block_is_on_preferred_chain(const chain::block_id_type& block_id);
 
-   static bool recover_reversible_blocks( const fc::path& db_dir,
-                                          uint32_t cache_size,
-                                          optional<fc::path> new_db_dir = optional<fc::path>(),
+   static bool recover_reversible_blocks( const fc::path& reversible_dir,
+                                          optional<fc::path> new_reversible_dir = optional<fc::path>(),
                                           uint32_t truncate_at_block = 0
                                         );
 
    static bool import_reversible_blocks( const fc::path& reversible_dir,
-                                         uint32_t cache_size,
                                          const fc::path& reversible_blocks_file
                                        );
 
@@ -774,6 +785,7 @@ FC_REFLECT(eosio::chain_apis::read_only::get_block_params, (block_num_or_id))
 FC_REFLECT(eosio::chain_apis::read_only::get_block_header_state_params, (block_num_or_id))
 
 FC_REFLECT( eosio::chain_apis::read_write::push_transaction_results, (transaction_id)(processed) )
+FC_REFLECT( eosio::chain_apis::read_write::send_transaction_binary_results, (transaction_id)(block_num)(receipt)(elapsed) )
 
 FC_REFLECT( eosio::chain_apis::read_only::get_table_rows_params, (json)(code)(scope)(table)(table_key)(lower_bound)(upper_bound)(limit)(key_type)(index_position)(encode_type)(reverse)(show_payer) )
 FC_REFLECT( eosio::chain_apis::read_only::get_table_rows_result, (rows)(more)(next_key) );
@@ -14,6 +14,11 @@
 
 #include <boost/asio.hpp>
 #include <boost/optional.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 
 #include <websocketpp/config/asio_client.hpp>
 #include <websocketpp/config/asio.hpp>
@@ -134,6 +139,7 @@ namespace eosio {
          virtual ~abstract_conn() {}
          virtual bool verify_max_bytes_in_flight() = 0;
          virtual void handle_exception() = 0;
+         virtual void send_service_unavailable( const std::string& what ) = 0;
       };
 
       using abstract_conn_ptr = std::shared_ptr<abstract_conn>;
@@ -170,6 +176,64 @@ namespace eosio {
       }
    }
 
+   namespace detail {
+      enum class content_encoding {
+         identity,
+         gzip,
+         deflate
+      };
+
+      /**
+       * Pick the response encoding from an Accept-Encoding request header, preferring gzip over deflate.
+       * Codings listed with q=0 are refused. A coding that is listed explicitly is decided by its own entry,
+       * "*" only applies to codings that are not listed.
+       */
+      static content_encoding negotiate_content_encoding( const string& accept_encoding ) {
+         fc::optional<bool> gzip, deflate, any;
+         vector<string> codings;
+         boost::split( codings, accept_encoding, boost::is_any_of( "," ) );
+         for( auto& coding : codings ) {
+            vector<string> params;
+            boost::split( params, coding, boost::is_any_of( ";" ) );
+            string name = boost::algorithm::to_lower_copy( boost::algorithm::trim_copy( params[0] ) );
+            bool refused = false;
+            for( size_t i = 1; i < params.size(); ++i ) {
+               string param = boost::algorithm::trim_copy( params[i] );
+               if( boost::algorithm::starts_with( param, "q=" ) ) {
+                  try {
+                     refused = std::stod( param.substr( 2 ) ) <= 0.0;
+                  } catch( ... ) {
+                     refused = true;
+                  }
+               }
+            }
+            if( name == "gzip" || name == "x-gzip" ) gzip = !refused;
+            else if( name == "deflate" ) deflate = !refused;
+            else if( name == "*" ) any = !refused;
+         }
+         bool any_accepted = any && *any;
+         if( gzip ? *gzip : any_accepted ) return content_encoding::gzip;
+         if( deflate ? *deflate : any_accepted ) return content_encoding::deflate;
+         return content_encoding::identity;
+      }
+
+      namespace bio = boost::iostreams;
+
+      static string compress_body( const string& body, content_encoding encoding ) {
+         string out;
+         out.reserve( body.size() / 4 );
+         bio::filtering_ostream comp;
+         if( encoding == content_encoding::gzip )
+            comp.push( bio::gzip_compressor( bio::gzip_params( bio::zlib::default_compression ) ) );
+         else
+            comp.push( bio::zlib_compressor( bio::zlib::default_compression ) ); // http "deflate" is the zlib format
+         comp.push( bio::back_inserter( out ) );
+         bio::write( comp, body.data(), body.size() );
+         bio::close( comp );
+         return out;
+      }
+   }
+
    using websocket_server_type = websocketpp::server<detail::asio_with_stub_log<websocketpp::transport::asio::basic_socket::endpoint>>;
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
    using websocket_local_server_type = websocketpp::server<detail::asio_local_with_stub_log>;
@@ -197,6 +261,7 @@ namespace eosio {
          std::atomic<size_t>                         bytes_in_flight{0};
          size_t                                      max_bytes_in_flight = 0;
          fc::microseconds                            max_response_time{30*1000};
+         size_t                                      compression_min_size = 0; ///< 0 disables response compression
 
          optional<tcp::endpoint>  https_listen_endpoint;
          string                   https_cert_chain;
@@ -340,6 +405,19 @@ namespace eosio {
             return true;
          }
 
+         template<typename T>
+         void send_service_unavailable( const T& con, const std::string& what ) {
+            fc_dlog( logger, "503 - ${what}", ("what", what) );
+            error_results::error_info ei;
+            ei.code = websocketpp::http::status_code::service_unavailable;
+            ei.name = "Busy";
+            ei.what = what;
+            error_results results{websocketpp::http::status_code::service_unavailable, "Busy", ei};
+            con->set_body( fc::json::to_string( results, fc::time_point::maximum() ));
+            con->set_status( websocketpp::http::status_code::service_unavailable );
+            con->send_http_response();
+         }
+
          /**
           * child struct, implementing abstract connection for various underlying connection types
           * that ties it to an http_plugin_impl
@@ -365,6 +443,10 @@ namespace eosio {
                http_plugin_impl::handle_exception<T>(_conn);
             }
 
+            void send_service_unavailable( const std::string& what ) override {
+               _impl.send_service_unavailable(_conn, what);
+            }
+
             detail::connection_ptr<T> _conn;
             http_plugin_impl &_impl;
          };
@@ -481,6 +563,36 @@ namespace eosio {
             };
          }
 
+         /**
+          * Make an internal_url_handler that will hand the url_handler to an executor, keeping the body
+          * accounted in bytes_in_flight until the executor has run or dropped it
+          *
+          * @pre b.size() has been added to bytes_in_flight by caller
+          * @param executor - runs the task on its own threads, or returns false to reject the request with a 503
+          * @param next - the next handler for responses
+          * @return the constructed internal_url_handler
+          */
+         detail::internal_url_handler make_executor_url_handler( url_executor executor, url_handler next ) {
+            auto next_ptr = std::make_shared<url_handler>(std::move(next));
+            return [this, executor=std::move(executor), next_ptr=std::move(next_ptr)]( detail::abstract_conn_ptr conn, string r, string b, url_response_callback then ) {
+               auto tracked_b = std::make_shared<in_flight<string>>( make_in_flight(std::move(b), *this) );
+               if (!conn->verify_max_bytes_in_flight()) {
+                  return;
+               }
+
+               bool queued = executor( [next_ptr, conn, r=std::move(r), tracked_b=std::move(tracked_b), then=std::move(then)]() mutable {
+                  try {
+                     (*next_ptr)( std::move( r ), std::move( **tracked_b ), std::move(then) );
+                  } catch( ... ) {
+                     conn->handle_exception();
+                  }
+               } );
+               if( !queued ) {
+                  conn->send_service_unavailable( "Too many queued requests" );
+               }
+            };
+         }
+
          /**
           * Make an internal_url_handler that will run the url_handler directly
           *
@@ -499,33 +611,69 @@ namespace eosio {
          }
 
          /**
-          * Construct a lambda appropriate for url_response_callback that will
-          * JSON-stringify the provided response
+          * Send a JSON response body, compressed when the client accepts it and the body is large enough.
+          * Every response large enough to be compressed varies on Accept-Encoding, whether or not it was,
+          * so caches do not hand an uncompressed body to a client asking for gzip or the other way around.
+          * Called on an http thread.
+          */
+         template<typename T>
+         void send_json_response( detail::connection_ptr<T> con, int code, string&& json, detail::content_encoding encoding ) {
+            const bool compressible = compression_min_size && json.size() >= compression_min_size;
+            if( compressible )
+               con->append_header( "Vary", "Accept-Encoding" );
+            if( compressible && encoding != detail::content_encoding::identity ) {
+               auto compressed = make_in_flight( detail::compress_body( json, encoding ), *this );
+               con->append_header( "Content-Encoding", encoding == detail::content_encoding::gzip ? "gzip" : "deflate" );
+               con->set_body( std::move( *compressed ) );
+            } else {
+               con->set_body( std::move( json ) );
+            }
+            con->set_status( websocketpp::http::status_code::value( code ) );
+            con->send_http_response();
+         }
+
+         /**
+          * Construct a url_response_callback that will JSON-stringify the provided
+          * response, or send a response that is already JSON as is
           *
           * @param con - pointer for the connection this response should be sent to
-          * @return lambda suitable for url_response_callback
+          * @param encoding - content encoding accepted by the client
+          * @return the url_response_callback
           */
          template<typename T>
-         auto make_http_response_handler( detail::connection_ptr<T> con ) {
-            return [this, con]( int code, fc::variant response ) {
+         url_response_callback make_http_response_handler( detail::connection_ptr<T> con, detail::content_encoding encoding ) {
+            auto send_variant = [this, con, encoding]( int code, fc::variant response ) {
                auto tracked_response = make_in_flight(std::move(response), *this);
                if (!verify_max_bytes_in_flight(con)) {
                   return;
                }
 
                // post  back to an HTTP thread to to allow the response handler to be called from any thread
-               boost::asio::post( thread_pool->get_executor(), [this, con, code, tracked_response=std::move(tracked_response)]() {
+               boost::asio::post( thread_pool->get_executor(), [this, con, code, encoding, tracked_response=std::move(tracked_response)]() {
                   try {
                      std::string json = fc::json::to_string( *tracked_response, fc::time_point::now() + max_response_time );
                      auto tracked_json = make_in_flight(std::move(json), *this);
-                     con->set_body( std::move( *tracked_json ) );
-                     con->set_status( websocketpp::http::status_code::value( code ) );
-                     con->send_http_response();
+                     send_json_response<T>( con, code, std::move( *tracked_json ), encoding );
                   } catch( ... ) {
                      handle_exception<T>( con );
                   }
                });
             };
+            auto send_json = [this, con, encoding]( int code, std::string json ) {
+               auto tracked_json = make_in_flight(std::move(json), *this);
+               if (!verify_max_bytes_in_flight(con)) {
+                  return;
+               }
+
+               boost::asio::post( thread_pool->get_executor(), [this, con, code, encoding, tracked_json=std::move(tracked_json)]() {
+                  try {
+                     send_json_response<T>( con, code, std::move( *tracked_json ), encoding );
+                  } catch( ... ) {
+                     handle_exception<T>( con );
+                  }
+               });
+            };
+            return url_response_callback( std::move(send_variant), std::move(send_json) );
          }
 
          template<class T>
@@ -563,7 +711,9 @@ namespace eosio {
                auto handler_itr = url_handlers.find( resource );
                if( handler_itr != url_handlers.end()) {
                   std::string body = con->get_request_body();
-                  handler_itr->second( make_abstract_conn_ptr<T>(con, *this), std::move( resource ), std::move( body ), make_http_response_handler<T>(con) );
+                  auto encoding = compression_min_size ? detail::negotiate_content_encoding( req.get_header( "Accept-Encoding" ) )
+                                                       : detail::content_encoding::identity;
+                  handler_itr->second( make_abstract_conn_ptr<T>(con, *this), std::move( resource ), std::move( body ), make_http_response_handler<T>(con, encoding) );
                } else {
                   fc_dlog( logger, "404 - not found: ${ep}", ("ep", resource) );
                   error_results results{websocketpp::http::status_code::not_found,
@@ -693,6 +843,9 @@ namespace eosio {
              "Additionaly acceptable values for the \"Host\" header of incoming HTTP requests, can be specified multiple times.  Includes http/s_server_address by default.")
             ("http-threads", bpo::value<uint16_t>()->default_value( my->thread_pool_size ),
              "Number of worker threads in http thread pool")
+            ("http-compression-min-size", bpo::value<uint32_t>()->default_value( 0 ),
+             "Responses of at least this many bytes are gzip or deflate compressed, on the http thread pool, for clients "
+             "that send a matching Accept-Encoding header. 0 disables response compression.")
             ;
    }
 
@@ -775,6 +928,7 @@ namespace eosio {
 
          my->max_bytes_in_flight = options.at( "http-max-bytes-in-flight-mb" ).as<uint32_t>() * 1024 * 1024;
          my->max_response_time = fc::microseconds( options.at("http-max-response-time-ms").as<uint32_t>() * 1000 );
+         my->compression_min_size = options.at( "http-compression-min-size" ).as<uint32_t>();
 
          //watch out for the returns above when adding new code here
       } FC_LOG_AND_RETHROW()
@@ -901,6 +1055,19 @@ namespace eosio {
       my->url_handlers[url] = my->make_http_thread_url_handler(handler);
    }
 
+   void http_plugin::add_executor_handler(const string& url, const url_handler& handler, const url_executor& executor) {
+      fc_ilog( logger, "add api url: ${c}", ("c", url) );
+      my->url_handlers[url] = my->make_executor_url_handler(executor, handler);
+   }
+
+   void url_response_callback::send_json( int code, std::string json ) const {
+      if( _json_cb ) {
+         _json_cb( code, std::move(json) );
+      } else {
+         _cb( code, fc::json::from_string( json ) );
+      }
+   }
+
    void http_plugin::handle_exception( const char *api_name, const char *call_name, const string& body, url_response_callback cb ) {
       try {
          try {
@@ -12,8 +12,37 @@ namespace eosio {
     * allow it to specify the HTTP response code and body
     *
     * Arguments: response_code, response_body
+    *
+    * A handler that has already written its response as JSON text can pass it
+    * to send_json() instead, so the http threads send it without converting it
+    * from an fc::variant.
     */
-   using url_response_callback = std::function<void(int,fc::variant)>;
+   class url_response_callback {
+   public:
+      using variant_callback = std::function<void(int,fc::variant)>;
+      using json_callback    = std::function<void(int,std::string)>;
+
+      url_response_callback() = default;
+
+      template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, url_response_callback>::value &&
+                                                       std::is_constructible<variant_callback, F>::value>>
+      url_response_callback( F&& cb )
+      : _cb( std::forward<F>(cb) ) {}
+
+      url_response_callback( variant_callback cb, json_callback json_cb )
+      : _cb( std::move(cb) ), _json_cb( std::move(json_cb) ) {}
+
+      void operator()( int code, fc::variant response ) const { _cb( code, std::move(response) ); }
+
+      /// respond with a body that is already JSON; parsed into an fc::variant when there is no json_callback
+      void send_json( int code, std::string json ) const;
+
+      explicit operator bool() const { return static_cast<bool>(_cb); }
+
+   private:
+      variant_callback _cb;
+      json_callback    _json_cb;
+   };
 
    /**
     * @brief Callback type for a URL handler
@@ -36,6 +65,14 @@ namespace eosio {
     */
    using api_description = std::map<string, url_handler>;
 
+   /**
+    * @brief Runs url handlers on threads other than the main and http threads
+    *
+    * Takes the task wrapping a url handler call and returns true once it is queued to run; returns false
+    * to drop it, in which case the request is answered with a 503.
+    **/
+   using url_executor = std::function<bool(std::function<void()>)>;
+
    struct http_plugin_defaults {
       //If empty, unix socket support will be completely disabled. If not empty,
       // unix socket support is enabled with the given default path (treated relative
@@ -89,6 +126,12 @@ namespace eosio {
               add_handler(call.first, call.second);
         }
 
+        void add_executor_handler(const string& url, const url_handler& handler, const url_executor& executor);
+        void add_executor_api(const api_description& api, const url_executor& executor) {
+           for (const auto& call : api)
+              add_executor_handler(call.first, call.second, executor);
+        }
+
         // standard exception handling for api handlers
         static void handle_exception( const char *api_name, const char *call_name, const string& body, url_response_callback cb );
 
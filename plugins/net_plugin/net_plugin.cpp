@@ -271,6 +271,9 @@ namespace eosio {
       uint16_t                                  thread_pool_size = 2;
       optional<eosio::chain::named_thread_pool> thread_pool;
 
+      uint32_t                                  sync_validation_depth = 0;
+      std::atomic<uint32_t>                     sync_blocks_validating{0}; ///< blocks posted for validation ahead of being processed
+
    private:
       mutable std::mutex            chain_info_mtx; // protects chain_*
       uint32_t                      chain_lib_num{0};
@@ -388,6 +391,7 @@ namespace eosio {
    constexpr auto     def_txn_expire_wait = std::chrono::seconds(3);
    constexpr auto     def_resp_expected_wait = std::chrono::seconds(5);
    constexpr auto     def_sync_fetch_span = 100;
+   constexpr auto     def_sync_validation_depth = 16;
 
    constexpr auto     message_header_size = 4;
    constexpr uint32_t signed_block_which = 7;        // see protocol net_message
@@ -2892,9 +2896,35 @@ namespace eosio {
    // called from connection strand
    void connection::handle_message( const block_id_type& id, signed_block_ptr ptr ) {
       peer_dlog( this, "received signed_block ${id}", ("id", ptr->block_num() ) );
-      auto priority = my_impl->sync_master->syncing_with_peer() ? priority::medium : priority::high;
-      app().post(priority, [ptr{std::move(ptr)}, id, c = shared_from_this()]() mutable {
+      const bool syncing = my_impl->sync_master->syncing_with_peer();
+      auto priority = syncing ? priority::medium : priority::high;
+
+      // While syncing, start validating the block on the chain thread pool as soon as it arrives. The high priority
+      // post runs ahead of the blocks already queued at medium priority, so up to sync_validation_depth blocks
+      // are validated against each other while the main thread applies the ones before them.
+      bool pipelined = false;
+      if( syncing ) {
+         pipelined = ++my_impl->sync_blocks_validating <= my_impl->sync_validation_depth;
+         if( !pipelined )
+            --my_impl->sync_blocks_validating;
+      }
+      if( pipelined ) {
+         app().post( priority::high, [ptr, id]() {
+            try {
+               // the controller keeps the started work, create_block_state_future for this block picks it up
+               my_impl->chain_plug->chain().create_block_state_future( ptr );
+            } catch( const fc::exception& ex ) {
+               // block is validated again, and the error reported, when it is processed
+               fc_dlog( logger, "unable to validate block #${n} ${id} ahead: ${m}",
+                        ("n", ptr->block_num())("id", id.str().substr(8,16))("m", ex.to_string()) );
+            }
+         });
+      }
+
+      app().post(priority, [ptr{std::move(ptr)}, id, c = shared_from_this(), pipelined]() mutable {
          c->process_signed_block( id, std::move( ptr ) );
+         if( pipelined )
+            --my_impl->sync_blocks_validating;
       });
    }
 
@@ -3291,6 +3321,8 @@ namespace eosio {
          ( "net-threads", bpo::value<uint16_t>()->default_value(my->thread_pool_size),
            "Number of worker threads in net_plugin thread pool" )
          ( "sync-fetch-span", bpo::value<uint32_t>()->default_value(def_sync_fetch_span), "number of blocks to retrieve in a chunk from any individual peer during synchronization")
+         ( "sync-validation-depth", bpo::value<uint32_t>()->default_value(def_sync_validation_depth),
+           "number of blocks received during synchronization whose headers, producer signatures and transaction signatures are validated on the chain thread pool ahead of being applied, 0 to disable")
          ( "use-socket-read-watermark", bpo::value<bool>()->default_value(false), "Enable experimental socket read watermark optimization")
          ( "peer-log-format", bpo::value<string>()->default_value( "[\"${_name}\" ${_ip}:${_port}]" ),
            "The string used to format peers when logging messages about them.  Variables are escaped with ${<variable name>}.\n"
@@ -3316,6 +3348,7 @@ namespace eosio {
          peer_log_format = options.at( "peer-log-format" ).as<string>();
 
          my->sync_master.reset( new sync_manager( options.at( "sync-fetch-span" ).as<uint32_t>()));
+         my->sync_validation_depth = options.at( "sync-validation-depth" ).as<uint32_t>();
 
          my->connector_period = std::chrono::seconds( options.at( "connection-cleanup-period" ).as<int>());
          my->max_cleanup_time_ms = options.at("max-cleanup-time-msec").as<int>();
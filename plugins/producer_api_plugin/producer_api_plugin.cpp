@@ -124,6 +124,8 @@ void producer_api_plugin::plugin_startup() {
                                  producer_plugin::get_supported_protocol_features_params), 201),
        CALL(producer, producer, get_account_ram_corrections,
             INVOKE_R_R(producer, get_account_ram_corrections, producer_plugin::get_account_ram_corrections_params), 201),
+       CALL(producer, producer, get_subjective_failures,
+            INVOKE_R_R(producer, get_subjective_failures, producer_plugin::get_subjective_failures_params), 201),
    }, appbase::priority::medium_high);
 }
 
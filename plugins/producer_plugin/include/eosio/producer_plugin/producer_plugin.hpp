@@ -22,6 +22,7 @@ public:
       fc::optional<int32_t>   subjective_cpu_leeway_us;
       fc::optional<double>    incoming_defer_ratio;
       fc::optional<uint32_t>  greylist_limit;
+      fc::optional<int64_t>   subjective_failure_limit_us;
    };
 
    struct whitelist_blacklist {
@@ -68,6 +69,24 @@ public:
       optional<account_name>   more;
    };
 
+   struct get_subjective_failures_params {
+      optional<account_name>  lower_bound; ///< first authorizer
+      uint32_t                limit = 100;
+   };
+
+   struct subjective_failure {
+      account_name            authorizer;
+      account_name            contract;
+      uint64_t                wasted_us = 0; ///< decayed to the time of the call
+      uint32_t                failures = 0;
+      fc::time_point          last_failure;
+   };
+
+   struct get_subjective_failures_result {
+      std::vector<subjective_failure> rows;
+      optional<account_name>          more; ///< lower_bound of the next page
+   };
+
    template<typename T>
    using next_function = std::function<void(const fc::static_variant<fc::exception_ptr, T>&)>;
 
@@ -110,13 +129,15 @@ public:
 
    get_account_ram_corrections_result  get_account_ram_corrections( const get_account_ram_corrections_params& params ) const;
 
+   get_subjective_failures_result get_subjective_failures( const get_subjective_failures_params& params ) const;
+
 private:
    std::shared_ptr<class producer_plugin_impl> my;
 };
 
 } //eosio
 
-FC_REFLECT(eosio::producer_plugin::runtime_options, (max_transaction_time)(max_irreversible_block_age)(produce_time_offset_us)(last_block_time_offset_us)(max_scheduled_transaction_time_per_block_ms)(subjective_cpu_leeway_us)(incoming_defer_ratio)(greylist_limit));
+FC_REFLECT(eosio::producer_plugin::runtime_options, (max_transaction_time)(max_irreversible_block_age)(produce_time_offset_us)(last_block_time_offset_us)(max_scheduled_transaction_time_per_block_ms)(subjective_cpu_leeway_us)(incoming_defer_ratio)(greylist_limit)(subjective_failure_limit_us));
 FC_REFLECT(eosio::producer_plugin::greylist_params, (accounts));
 FC_REFLECT(eosio::producer_plugin::whitelist_blacklist, (actor_whitelist)(actor_blacklist)(contract_whitelist)(contract_blacklist)(action_blacklist)(key_blacklist) )
 FC_REFLECT(eosio::producer_plugin::integrity_hash_information, (head_block_id)(integrity_hash))
@@ -125,3 +146,6 @@ FC_REFLECT(eosio::producer_plugin::scheduled_protocol_feature_activations, (prot
 FC_REFLECT(eosio::producer_plugin::get_supported_protocol_features_params, (exclude_disabled)(exclude_unactivatable))
 FC_REFLECT(eosio::producer_plugin::get_account_ram_corrections_params, (lower_bound)(upper_bound)(limit)(reverse))
 FC_REFLECT(eosio::producer_plugin::get_account_ram_corrections_result, (rows)(more))
+FC_REFLECT(eosio::producer_plugin::get_subjective_failures_params, (lower_bound)(limit))
+FC_REFLECT(eosio::producer_plugin::subjective_failure, (authorizer)(contract)(wasted_us)(failures)(last_failure))
+FC_REFLECT(eosio::producer_plugin::get_subjective_failures_result, (rows)(more))
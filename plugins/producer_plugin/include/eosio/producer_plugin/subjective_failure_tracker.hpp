@@ -0,0 +1,92 @@
+#pragma once
+
+#include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/trace.hpp>
+#include <eosio/chain/transaction_metadata.hpp>
+
+#include <cmath>
+#include <map>
+
+namespace eosio {
+
+/**
+ * Tracks the CPU time wasted on recently failed transactions, keyed by first authorizer and the contract of
+ * the first action, so that repeat offenders can be rejected before they are executed again.
+ * The wasted time of a key decays by half every half life.
+ */
+class subjective_failure_tracker {
+public:
+   using key_type = std::pair<chain::account_name, chain::account_name>; ///< first authorizer, contract
+
+   struct entry {
+      double           wasted_us = 0; ///< as of last_update
+      fc::time_point   last_update;
+      uint32_t         failures = 0;
+   };
+
+   static key_type key_for( const chain::transaction_metadata_ptr& trx ) {
+      const auto& t = trx->packed_trx()->get_transaction();
+      return { t.first_authorizer(), t.actions.empty() ? chain::account_name() : t.actions.front().account };
+   }
+
+   /**
+    * Whether a failed trace may be charged to key_for() of its transaction. The key comes from the declared
+    * authorizations, so only failures after they were satisfied count; otherwise anyone could get a victim's
+    * transactions rejected by naming the victim in transactions they cannot sign. Authorization is checked
+    * before any action runs, so a trace without action traces failed before its authorizations were proven.
+    */
+   static bool is_chargeable( const chain::transaction_trace& trace ) {
+      if( !trace.except || trace.action_traces.empty() ) return false;
+      switch( trace.except->code() ) {
+         case chain::unsatisfied_authorization::code_value:
+         case chain::irrelevant_auth_exception::code_value:
+         case chain::tx_irrelevant_sig::code_value:
+         case chain::tx_duplicate_sig::code_value:
+         case chain::expired_tx_exception::code_value:
+         case chain::tx_duplicate::code_value:
+            return false;
+         default:
+            return true;
+      }
+   }
+
+   void set_half_life( fc::microseconds hl ) { half_life = hl; }
+
+   void record_failure( const key_type& key, fc::microseconds wasted, const fc::time_point& now ) {
+      auto& e = entries[key];
+      e.wasted_us = decayed( e, now ) + wasted.count();
+      e.last_update = now;
+      ++e.failures;
+   }
+
+   /// CPU time wasted by key as of now
+   double wasted_us( const key_type& key, const fc::time_point& now ) const {
+      auto itr = entries.find( key );
+      if( itr == entries.end() ) return 0;
+      return decayed( itr->second, now );
+   }
+
+   /// drop keys that have decayed to less than 1us
+   void prune( const fc::time_point& now ) {
+      for( auto itr = entries.begin(); itr != entries.end(); ) {
+         if( decayed( itr->second, now ) < 1 ) {
+            itr = entries.erase( itr );
+         } else {
+            ++itr;
+         }
+      }
+   }
+
+   const std::map<key_type, entry>& get_entries() const { return entries; }
+
+private:
+   double decayed( const entry& e, const fc::time_point& now ) const {
+      if( half_life.count() <= 0 || now <= e.last_update ) return e.wasted_us;
+      return e.wasted_us * std::exp2( -double( (now - e.last_update).count() ) / half_life.count() );
+   }
+
+   std::map<key_type, entry> entries;
+   fc::microseconds          half_life = fc::seconds( 60 );
+};
+
+} // namespace eosio
@@ -1,4 +1,5 @@
 #include <eosio/producer_plugin/producer_plugin.hpp>
+#include <eosio/producer_plugin/subjective_failure_tracker.hpp>
 #include <eosio/chain/plugin_interface.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/generated_transaction_object.hpp>
@@ -17,6 +18,12 @@
 
 #include <iostream>
 #include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/range/adaptor/map.hpp>
 #include <boost/function_output_iterator.hpp>
@@ -158,6 +165,27 @@ public:
    std::string       final_path;
 };
 
+/// writes a snapshot of the current state of `chain` to `p`
+static void write_snapshot_file( const chain::controller& chain, const bfs::path& p ) {
+   bfs::create_directory( p.parent_path() );
+
+   auto snap_out = std::ofstream(p.generic_string(), (std::ios::out | std::ios::binary));
+   auto writer = std::make_shared<ostream_snapshot_writer>(snap_out);
+   chain.write_snapshot(writer);
+   writer->finalize();
+   snap_out.flush();
+   snap_out.close();
+}
+
+/// a snapshot being written by a forked child process
+struct async_snapshot {
+   pid_t                      pid = 0;
+   block_id_type              block_id;
+   bfs::path                  temp_path;
+   bfs::path                  final_path;
+   pending_snapshot::next_t   next;
+};
+
 using pending_snapshot_index = multi_index_container<
    pending_snapshot,
    indexed_by<
@@ -234,6 +262,24 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
       fc::optional<scoped_connection>                          _accepted_block_connection;
       fc::optional<scoped_connection>                          _accepted_block_header_connection;
       fc::optional<scoped_connection>                          _irreversible_block_connection;
+      fc::optional<scoped_connection>                          _applied_transaction_connection;
+
+      // the pending block, started while waiting for our production window, that will be produced once it opens
+      struct pre_assembled_block {
+         fc::time_point   block_time;
+         block_id_type    head_id;
+      };
+      bool                                                     _pre_assemble_blocks = false;
+      fc::optional<pre_assembled_block>                        _pre_assembled_block;
+
+      subjective_failure_tracker                               _subjective_failures;
+      int64_t                                                  _subjective_failure_limit_us = 0; // 0 disables
+
+      // accounts touched by transactions of blocks applied since the last complete pass over the persisted
+      // transactions, used to skip re-running persisted transactions that no block could have affected
+      bool                                                     _reapply_touched_trxs_only = false;
+      flat_set<account_name>                                   _touched_accounts;
+      bool                                                     _touched_accounts_complete = false;
 
       /*
        * HACK ALERT
@@ -253,6 +299,18 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
       // path to write the snapshots to
       bfs::path _snapshots_dir;
 
+      // write snapshots from a forked child process instead of on the main thread
+      bool                                                     _async_snapshots = false;
+      std::vector<async_snapshot>                              _async_snapshots_in_flight;
+      fc::optional<boost::asio::signal_set>                    _sigchld;
+
+      void start_async_snapshot( const block_id_type& block_id, const bfs::path& temp_path, const bfs::path& final_path,
+                                 pending_snapshot::next_t next );
+      void wait_for_async_snapshots();
+      void reap_async_snapshots();
+      void on_async_snapshot_written( async_snapshot& snap, bool success );
+      void stop_async_snapshots();
+
       void consider_new_watermark( account_name producer, uint32_t block_num, block_timestamp_type timestamp) {
          auto itr = _producer_watermarks.find( producer );
          if( itr != _producer_watermarks.end() ) {
@@ -273,6 +331,36 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
 
       void on_block( const block_state_ptr& bsp ) {
          _unapplied_transactions.clear_applied( bsp );
+         if( _subjective_failure_limit_us > 0 ) {
+            _subjective_failures.prune( fc::time_point::now() );
+         }
+      }
+
+      void on_applied_transaction( const transaction_trace_ptr& trace ) {
+         // only transactions of blocks being applied, our own speculative ones are aborted with the pending block
+         if( trace->producer_block_id ) {
+            add_footprint( *trace, _touched_accounts );
+         }
+      }
+
+      /// Accounts whose state a transaction wrote or read through the multi_index tables. Tables of eosio hold
+      /// global state (rammarket, global config) and every block's onblock touches eosio, so a transaction reading
+      /// them is always re-run. State read any other way (block time, tapos, account existence) is not covered.
+      static void add_footprint( const transaction_trace& trace, flat_set<account_name>& footprint ) {
+         footprint.insert( trace.table_codes_read.begin(), trace.table_codes_read.end() );
+         for( const auto& at : trace.action_traces ) {
+            footprint.insert( at.receiver );
+            footprint.insert( at.act.account );
+            for( const auto& auth : at.act.authorization ) {
+               footprint.insert( auth.actor );
+            }
+            for( const auto& delta : at.account_ram_deltas ) {
+               footprint.insert( delta.account );
+            }
+         }
+         if( trace.account_ram_delta ) {
+            footprint.insert( trace.account_ram_delta->account );
+         }
       }
 
       void on_block_header( const block_state_ptr& bsp ) {
@@ -372,6 +460,8 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
          // push the new block
          try {
             chain.push_block( bsf, [this]( const branch_type& forked_branch ) {
+               // state written by the forked out blocks is not in _touched_accounts
+               _touched_accounts_complete = false;
                _unapplied_transactions.add_forked( forked_branch );
             }, [this]( const transaction_id_type& id ) {
                return _unapplied_transactions.get_trx( id );
@@ -528,6 +618,17 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
                return true;
             }
 
+            if( _subjective_failure_limit_us > 0 ) {
+               const auto key = subjective_failure_tracker::key_for( trx );
+               const auto wasted_us = _subjective_failures.wasted_us( key, fc::time_point::now() );
+               if( wasted_us >= _subjective_failure_limit_us ) {
+                  send_response( std::static_pointer_cast<fc::exception>( std::make_shared<tx_resource_exhaustion>(
+                        FC_LOG_MESSAGE( error, "transaction ${id} rejected, ${a} recently wasted ${w}us on failed transactions to ${c}",
+                                        ("id", id)("a", key.first)("w", uint64_t(wasted_us))("c", key.second) ))) );
+                  return true;
+               }
+            }
+
             if( !chain.is_building_block()) {
                _pending_incoming_transactions.add( trx, persist_until_expired, next );
                return true;
@@ -558,6 +659,9 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
                   if( !exhausted )
                      exhausted = block_is_exhausted();
                } else {
+                  if( _subjective_failure_limit_us > 0 && subjective_failure_tracker::is_chargeable( *trace ) ) {
+                     _subjective_failures.record_failure( subjective_failure_tracker::key_for( trx ), trace->elapsed, fc::time_point::now() );
+                  }
                   auto e_ptr = trace->except->dynamic_copy_exception();
                   send_response( e_ptr );
                }
@@ -565,7 +669,11 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
                if( persist_until_expired ) {
                   // if this trx didnt fail/soft-fail and the persist flag is set, store its ID so that we can
                   // ensure its applied to all future speculative blocks as well.
-                  _unapplied_transactions.add_persisted( trx );
+                  flat_set<account_name> footprint;
+                  if( _reapply_touched_trxs_only ) {
+                     add_footprint( *trace, footprint );
+                  }
+                  _unapplied_transactions.add_persisted( trx, std::move( footprint ) );
                }
                send_response( trace );
             }
@@ -604,6 +712,8 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
       };
 
       start_block_result start_block();
+      bool is_pre_assembled( const fc::optional<pre_assembled_block>& pab, const fc::time_point& block_time ) const;
+      void start_pending_block( const block_state_ptr& hbs, const fc::time_point& block_time, uint16_t blocks_to_confirm );
 
       fc::time_point calculate_pending_block_time() const;
       fc::time_point calculate_block_deadline( const fc::time_point& ) const;
@@ -700,6 +810,30 @@ void producer_plugin::set_program_options(
           "Number of worker threads in producer thread pool")
          ("snapshots-dir", bpo::value<bfs::path>()->default_value("snapshots"),
           "the location of the snapshots directory (absolute path or relative to application data dir)")
+         ("async-snapshots", bpo::bool_switch()->default_value(false),
+          "Write snapshots from a forked child process while this node keeps applying blocks. "
+          "Requires database-map-mode heap or locked without database-hugepage-path, so the child sees a "
+          "copy-on-write image of the state; otherwise snapshots are written on the main thread.")
+         ("subjective-failure-limit-us", bpo::value<int64_t>()->default_value(0),
+          "Reject incoming transactions without executing them once failed transactions with the same first authorizer "
+          "and first contract have wasted this many microseconds of CPU, decayed over subjective-failure-half-life-ms. Only failures "
+          "after the declared authorizations were satisfied count. 0 disables.")
+         ("subjective-failure-half-life-ms", bpo::value<uint32_t>()->default_value(60000),
+          "Time in milliseconds for the CPU wasted by failed transactions to decay by half")
+         ("pre-assemble-blocks", bpo::bool_switch()->default_value(false),
+          "Start the next block this node will produce as soon as the previous block is applied instead of when its "
+          "production window opens, so transactions arriving in between are already in it when the window opens")
+         ("priority-account", boost::program_options::value<vector<string>>()->composing()->multitoken(),
+          "first authorizer whose transactions aborted with a pending block are retried ahead of other aborted transactions")
+         ("prefer-cheap-unapplied-trxs", bpo::bool_switch()->default_value(false),
+          "Retry transactions aborted with a pending block in order of the CPU they were billed on their last run, cheapest "
+          "first, so more of them fit in a block and the most expensive are the ones left behind")
+         ("reapply-touched-trxs-only", bpo::bool_switch()->default_value(false),
+          "While speculating, only re-run persisted transactions when a block applied since their last run touched "
+          "one of the accounts they touched or whose tables they read. Untouched transactions stay queued until this "
+          "node produces or they expire and are missing from the speculative state until then, so API reads and "
+          "transactions that depend on them may see older state. Changes to state other than contract tables, such as "
+          "the block time, are not tracked.")
          ;
    config_file_options.add(producer_options);
 }
@@ -783,6 +917,25 @@ void producer_plugin::plugin_initialize(const boost::program_options::variables_
             unapplied_transaction_queue::process_mode::speculative_producer;
    my->_unapplied_transactions.set_mode( unapplied_mode );
 
+   flat_set<account_name> priority_accounts;
+   LOAD_VALUE_SET(options, "priority-account", priority_accounts)
+   const bool prefer_cheap = options.at( "prefer-cheap-unapplied-trxs" ).as<bool>();
+   if( !priority_accounts.empty() || prefer_cheap ) {
+      // priority accounts first, then by CPU billed on the last run, cheapest first
+      my->_unapplied_transactions.set_priority_function(
+            [priority_accounts{std::move( priority_accounts )}, prefer_cheap]( const transaction_metadata_ptr& trx ) -> int64_t {
+               int64_t p = 0;
+               if( !priority_accounts.empty() &&
+                   priority_accounts.count( trx->packed_trx()->get_transaction().first_authorizer() ) ) {
+                  p += int64_t(1) << 32;
+               }
+               if( prefer_cheap ) {
+                  p -= trx->billed_cpu_time_us;
+               }
+               return p;
+            } );
+   }
+
    if( options.count("private-key") )
    {
       const std::vector<std::string> key_id_to_wif_pair_strings = options["private-key"].as<std::vector<std::string>>();
@@ -899,6 +1052,21 @@ void producer_plugin::plugin_initialize(const boost::program_options::variables_
                   "No such directory '${dir}'", ("dir", my->_snapshots_dir.generic_string()) );
    }
 
+   if( options.at( "async-snapshots" ).as<bool>() ) {
+      if( my->chain_plug->chain().is_state_in_private_memory() ) {
+         my->_async_snapshots = true;
+      } else {
+         wlog( "async-snapshots ignored: the state database must be in heap or locked map mode without hugepages "
+               "for a forked process to see a stable image of it; snapshots will be written on the main thread" );
+      }
+   }
+
+   my->_reapply_touched_trxs_only = options.at( "reapply-touched-trxs-only" ).as<bool>();
+   my->_pre_assemble_blocks = options.at( "pre-assemble-blocks" ).as<bool>();
+
+   my->_subjective_failure_limit_us = options.at( "subjective-failure-limit-us" ).as<int64_t>();
+   my->_subjective_failures.set_half_life( fc::milliseconds( options.at( "subjective-failure-half-life-ms" ).as<uint32_t>() ) );
+
    my->_incoming_block_subscription = app().get_channel<incoming::channels::block>().subscribe(
          [this](const signed_block_ptr& block) {
       try {
@@ -959,6 +1127,12 @@ void producer_plugin::plugin_startup()
    my->_accepted_block_connection.emplace(chain.accepted_block.connect( [this]( const auto& bsp ){ my->on_block( bsp ); } ));
    my->_accepted_block_header_connection.emplace(chain.accepted_block_header.connect( [this]( const auto& bsp ){ my->on_block_header( bsp ); } ));
    my->_irreversible_block_connection.emplace(chain.irreversible_block.connect( [this]( const auto& bsp ){ my->on_irreversible_block( bsp->block ); } ));
+   if( my->_reapply_touched_trxs_only ) {
+      my->_applied_transaction_connection.emplace(chain.applied_transaction.connect(
+            [this]( std::tuple<const transaction_trace_ptr&, const signed_transaction&> t ) {
+               my->on_applied_transaction( std::get<0>( t ) );
+            } ));
+   }
 
    const auto lib_num = chain.last_irreversible_block_num();
    const auto lib = chain.fetch_block_by_number(lib_num);
@@ -999,6 +1173,8 @@ void producer_plugin::plugin_shutdown() {
       my->_thread_pool->stop();
    }
 
+   my->stop_async_snapshots();
+
    app().post( 0, [me = my](){} ); // keep my pointer alive until queue is drained
 }
 
@@ -1060,6 +1236,10 @@ void producer_plugin::update_runtime_options(const runtime_options& options) {
       my->_incoming_defer_ratio = *options.incoming_defer_ratio;
    }
 
+   if (options.subjective_failure_limit_us) {
+      my->_subjective_failure_limit_us = *options.subjective_failure_limit_us;
+   }
+
    if (check_speculating && my->_pending_block_mode == pending_block_mode::speculating) {
       my->_unapplied_transactions.add_aborted( chain.abort_block() );
       my->schedule_production_loop();
@@ -1085,7 +1265,8 @@ producer_plugin::runtime_options producer_plugin::get_runtime_options() const {
             my->chain_plug->chain().get_subjective_cpu_leeway()->count() :
             fc::optional<int32_t>(),
       my->_incoming_defer_ratio,
-      my->chain_plug->chain().get_greylist_limit()
+      my->chain_plug->chain().get_greylist_limit(),
+      my->_subjective_failure_limit_us
    };
 }
 
@@ -1179,19 +1360,19 @@ void producer_plugin::create_snapshot(producer_plugin::next_function<producer_pl
          reschedule.cancel();
       }
 
-      bfs::create_directory( p.parent_path() );
-
       // create the snapshot
-      auto snap_out = std::ofstream(p.generic_string(), (std::ios::out | std::ios::binary));
-      auto writer = std::make_shared<ostream_snapshot_writer>(snap_out);
-      chain.write_snapshot(writer);
-      writer->finalize();
-      snap_out.flush();
-      snap_out.close();
+      write_snapshot_file( chain, p );
    };
 
    // If in irreversible mode, create snapshot and return path to snapshot immediately.
    if( chain.get_read_mode() == db_read_mode::IRREVERSIBLE ) {
+      if( my->_async_snapshots ) {
+         try {
+            my->start_async_snapshot( head_id, temp_path, snapshot_path, next );
+         } CATCH_AND_CALL (next);
+         return;
+      }
+
       try {
          write_snapshot( temp_path );
 
@@ -1221,6 +1402,10 @@ void producer_plugin::create_snapshot(producer_plugin::next_function<producer_pl
             next(res);
          };
       });
+   } else if( my->_async_snapshots ) {
+      try {
+         my->start_async_snapshot( head_id, temp_path, snapshot_path, next );
+      } CATCH_AND_CALL (next);
    } else {
       const auto& pending_path = pending_snapshot::get_pending_path(head_id, my->_snapshots_dir);
 
@@ -1240,6 +1425,132 @@ void producer_plugin::create_snapshot(producer_plugin::next_function<producer_pl
    }
 }
 
+void producer_plugin_impl::start_async_snapshot( const block_id_type& block_id, const bfs::path& temp_path,
+                                                 const bfs::path& final_path, pending_snapshot::next_t next ) {
+   // if a snapshot of this block is already being written, attach this requests handler to it
+   for( auto& in_flight : _async_snapshots_in_flight ) {
+      if( in_flight.block_id == block_id ) {
+         in_flight.next = [prev = in_flight.next, next](const fc::static_variant<fc::exception_ptr, producer_plugin::snapshot_information>& res){
+            prev(res);
+            next(res);
+         };
+         return;
+      }
+   }
+
+   chain::controller& chain = chain_plug->chain();
+
+   auto reschedule = fc::make_scoped_exit([this](){
+      schedule_production_loop();
+   });
+
+   if (chain.is_building_block()) {
+      // abort the pending block so the child sees the state at head
+      _unapplied_transactions.add_aborted( chain.abort_block() );
+   } else {
+      reschedule.cancel();
+   }
+
+   // registered before forking so an early exit of the child is not missed
+   if( !_sigchld ) {
+      _sigchld.emplace( app().get_io_service(), SIGCHLD );
+   }
+
+   pid_t pid = fork();
+   if( pid == 0 ) {
+      // child: the state is a copy-on-write image of the parent's, frozen at block_id
+      int rc = 1;
+      try {
+         write_snapshot_file( chain, temp_path );
+         rc = 0;
+      } catch( ... ) {}
+      _exit( rc );
+   }
+   EOS_ASSERT( pid > 0, snapshot_write_exception, "Unable to fork snapshot writer: ${e}", ("e", strerror(errno)) );
+
+   fc_ilog( _log, "Writing snapshot of block ${n} from process ${pid}", ("n", block_header::num_from_id(block_id))("pid", pid) );
+   _async_snapshots_in_flight.push_back( async_snapshot{pid, block_id, temp_path, final_path, std::move(next)} );
+   if( _async_snapshots_in_flight.size() == 1 )
+      wait_for_async_snapshots();
+}
+
+void producer_plugin_impl::wait_for_async_snapshots() {
+   _sigchld->async_wait( app().get_priority_queue().wrap( priority::medium,
+      [weak_this = weak_from_this()]( const boost::system::error_code& ec, int ) {
+         auto self = weak_this.lock();
+         if( !self || ec ) return;
+         self->reap_async_snapshots();
+         if( !self->_async_snapshots_in_flight.empty() )
+            self->wait_for_async_snapshots();
+      } ) );
+}
+
+void producer_plugin_impl::reap_async_snapshots() {
+   for( auto itr = _async_snapshots_in_flight.begin(); itr != _async_snapshots_in_flight.end(); ) {
+      int status = 0;
+      pid_t r = waitpid( itr->pid, &status, WNOHANG );
+      if( r == 0 || (r < 0 && errno == EINTR) ) {
+         ++itr;
+         continue;
+      }
+      auto snap = std::move( *itr );
+      itr = _async_snapshots_in_flight.erase( itr );
+      on_async_snapshot_written( snap, r == snap.pid && WIFEXITED(status) && WEXITSTATUS(status) == 0 );
+   }
+}
+
+void producer_plugin_impl::on_async_snapshot_written( async_snapshot& snap, bool success ) {
+   const chain::controller& chain = chain_plug->chain();
+   const uint32_t block_num = block_header::num_from_id( snap.block_id );
+   auto& next = snap.next;
+   try {
+      if( !success ) {
+         boost::system::error_code ec;
+         bfs::remove( snap.temp_path, ec );
+         EOS_THROW( snapshot_write_exception, "Snapshot writer process ${pid} for block number ${bn} failed",
+                    ("pid", snap.pid)("bn", block_num) );
+      }
+
+      boost::system::error_code ec;
+      if( chain.get_read_mode() == db_read_mode::IRREVERSIBLE ) {
+         bfs::rename(snap.temp_path, snap.final_path, ec);
+         EOS_ASSERT(!ec, snapshot_finalization_exception,
+               "Unable to finalize valid snapshot of block number ${bn}: [code: ${ec}] ${message}",
+               ("bn", block_num)
+               ("ec", ec.value())
+               ("message", ec.message()));
+
+         next( producer_plugin::snapshot_information{snap.block_id, snap.final_path.generic_string()} );
+      } else {
+         // same as a snapshot written on the main thread: finalized once the block becomes irreversible
+         const auto& pending_path = pending_snapshot::get_pending_path(snap.block_id, _snapshots_dir);
+         bfs::rename(snap.temp_path, pending_path, ec);
+         EOS_ASSERT(!ec, snapshot_finalization_exception,
+               "Unable to promote temp snapshot to pending for block number ${bn}: [code: ${ec}] ${message}",
+               ("bn", block_num)
+               ("ec", ec.value())
+               ("message", ec.message()));
+
+         _pending_snapshot_index.emplace(snap.block_id, next, pending_path.generic_string(), snap.final_path.generic_string());
+      }
+   } CATCH_AND_CALL (next);
+}
+
+void producer_plugin_impl::stop_async_snapshots() {
+   if( _sigchld ) {
+      boost::system::error_code ec;
+      _sigchld->cancel( ec );
+   }
+   for( auto& snap : _async_snapshots_in_flight ) {
+      kill( snap.pid, SIGKILL );
+      int status = 0;
+      waitpid( snap.pid, &status, 0 );
+      boost::system::error_code ec;
+      bfs::remove( snap.temp_path, ec );
+   }
+   _async_snapshots_in_flight.clear();
+}
+
 producer_plugin::scheduled_protocol_feature_activations
 producer_plugin::get_scheduled_protocol_feature_activations()const {
    return {my->_protocol_features_to_activate};
@@ -1261,6 +1572,7 @@ void producer_plugin::schedule_protocol_feature_activations( const scheduled_pro
    }
    my->_protocol_features_to_activate = schedule.protocol_features_to_activate;
    my->_protocol_features_signaled = false;
+   my->_pre_assembled_block.reset(); // assembled with the previous features
 }
 
 fc::variants producer_plugin::get_supported_protocol_features( const get_supported_protocol_features_params& params ) const {
@@ -1345,6 +1657,28 @@ producer_plugin::get_account_ram_corrections( const get_account_ram_corrections_
    return result;
 }
 
+producer_plugin::get_subjective_failures_result
+producer_plugin::get_subjective_failures( const get_subjective_failures_params& params ) const {
+   get_subjective_failures_result result;
+   const auto now = fc::time_point::now();
+   const auto& entries = my->_subjective_failures.get_entries();
+
+   auto itr = params.lower_bound ? entries.lower_bound( { *params.lower_bound, account_name() } ) : entries.begin();
+   // pages end on an authorizer boundary since lower_bound only names the authorizer; a limit of 0 returns no rows
+   for( ; itr != entries.end(); ++itr ) {
+      if( result.rows.size() >= params.limit &&
+          ( result.rows.empty() || result.rows.back().authorizer != itr->first.first ) ) {
+         result.more = itr->first.first;
+         break;
+      }
+      result.rows.push_back( { itr->first.first, itr->first.second,
+                               uint64_t( my->_subjective_failures.wasted_us( itr->first, now ) ),
+                               itr->second.failures, itr->second.last_update } );
+   }
+
+   return result;
+}
+
 optional<fc::time_point> producer_plugin_impl::calculate_next_block_time(const account_name& producer_name, const block_timestamp_type& current_block_time) const {
    chain::controller& chain = chain_plug->chain();
    const auto& hbs = chain.head_block_state();
@@ -1419,9 +1753,61 @@ fc::time_point producer_plugin_impl::calculate_block_deadline( const fc::time_po
    return block_time + fc::microseconds(last_block ? _last_block_time_offset_us : _produce_time_offset_us);
 }
 
+void producer_plugin_impl::start_pending_block( const block_state_ptr& hbs, const fc::time_point& block_time, uint16_t blocks_to_confirm ) {
+   chain::controller& chain = chain_plug->chain();
+
+   _unapplied_transactions.add_aborted( chain.abort_block() );
+
+   auto features_to_activate = chain.get_preactivated_protocol_features();
+   if( _pending_block_mode == pending_block_mode::producing && _protocol_features_to_activate.size() > 0 ) {
+      bool drop_features_to_activate = false;
+      try {
+         chain.validate_protocol_features( _protocol_features_to_activate );
+      } catch( const fc::exception& e ) {
+         wlog( "protocol features to activate are no longer all valid: ${details}",
+               ("details",e.to_detail_string()) );
+         drop_features_to_activate = true;
+      }
+
+      if( drop_features_to_activate ) {
+         _protocol_features_to_activate.clear();
+      } else {
+         auto protocol_features_to_activate = _protocol_features_to_activate; // do a copy as pending_block might be aborted
+         if( features_to_activate.size() > 0 ) {
+            protocol_features_to_activate.reserve( protocol_features_to_activate.size()
+                                                      + features_to_activate.size() );
+            std::set<digest_type> set_of_features_to_activate( protocol_features_to_activate.begin(),
+                                                               protocol_features_to_activate.end() );
+            for( const auto& f : features_to_activate ) {
+               auto res = set_of_features_to_activate.insert( f );
+               if( res.second ) {
+                  protocol_features_to_activate.push_back( f );
+               }
+            }
+            features_to_activate.clear();
+         }
+         std::swap( features_to_activate, protocol_features_to_activate );
+         _protocol_features_signaled = true;
+         ilog( "signaling activation of the following protocol features in block ${num}: ${features_to_activate}",
+               ("num", hbs->block_num + 1)("features_to_activate", features_to_activate) );
+      }
+   }
+
+   chain.start_block( block_time, blocks_to_confirm, features_to_activate );
+}
+
+bool producer_plugin_impl::is_pre_assembled( const fc::optional<pre_assembled_block>& pab, const fc::time_point& block_time ) const {
+   const chain::controller& chain = chain_plug->chain();
+   return pab && pab->block_time == block_time && _protocol_features_to_activate.empty() && chain.is_building_block() &&
+          chain.pending_block_time() == block_time && chain.head_block_id() == pab->head_id;
+}
+
 producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
    chain::controller& chain = chain_plug->chain();
 
+   auto pre_assembled = std::move( _pre_assembled_block );
+   _pre_assembled_block.reset();
+
    if( !chain_plug->accept_transactions() )
       return start_block_result::waiting_for_block;
 
@@ -1490,13 +1876,24 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
          return start_block_result::waiting_for_block;
    }
 
+   bool pre_assemble = false;
+   fc::time_point pre_assemble_deadline;
    if (_pending_block_mode == pending_block_mode::producing) {
       const auto start_block_time = block_time - fc::microseconds( config::block_interval_us );
       if( now < start_block_time ) {
          fc_dlog(_log, "Not producing block waiting for production window ${n} ${bt}", ("n", hbs->block_num + 1)("bt", block_time) );
          // start_block_time instead of block_time because schedule_delayed_production_loop calculates next block time from given time
          schedule_delayed_production_loop(weak_from_this(), calculate_producer_wake_up_time(start_block_time));
-         return start_block_result::waiting_for_production;
+         // a block signaling protocol features is only started once the window opens
+         if( !_pre_assemble_blocks || !_protocol_features_to_activate.empty() )
+            return start_block_result::waiting_for_production;
+         if( is_pre_assembled( pre_assembled, block_time ) ) {
+            _pre_assembled_block = std::move( pre_assembled );
+            return start_block_result::waiting_for_production;
+         }
+         // start the block now as a speculative block, it is produced as is when the window opens
+         pre_assemble = true;
+         pre_assemble_deadline = start_block_time;
       }
    } else if (previous_pending_mode == pending_block_mode::producing) {
       // just produced our last block of our round
@@ -1530,49 +1927,24 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
          blocks_to_confirm = (uint16_t)(std::min<uint32_t>(blocks_to_confirm, (uint32_t)(hbs->block_num - hbs->dpos_irreversible_blocknum)));
       }
 
-      _unapplied_transactions.add_aborted( chain.abort_block() );
-
-      auto features_to_activate = chain.get_preactivated_protocol_features();
-      if( _pending_block_mode == pending_block_mode::producing && _protocol_features_to_activate.size() > 0 ) {
-         bool drop_features_to_activate = false;
-         try {
-            chain.validate_protocol_features( _protocol_features_to_activate );
-         } catch( const fc::exception& e ) {
-            wlog( "protocol features to activate are no longer all valid: ${details}",
-                  ("details",e.to_detail_string()) );
-            drop_features_to_activate = true;
-         }
+      // speculative until the window opens, so start_pending_block does not signal protocol features for it
+      if( pre_assemble )
+         _pending_block_mode = pending_block_mode::speculating;
 
-         if( drop_features_to_activate ) {
-            _protocol_features_to_activate.clear();
-         } else {
-            auto protocol_features_to_activate = _protocol_features_to_activate; // do a copy as pending_block might be aborted
-            if( features_to_activate.size() > 0 ) {
-               protocol_features_to_activate.reserve( protocol_features_to_activate.size()
-                                                         + features_to_activate.size() );
-               std::set<digest_type> set_of_features_to_activate( protocol_features_to_activate.begin(),
-                                                                  protocol_features_to_activate.end() );
-               for( const auto& f : features_to_activate ) {
-                  auto res = set_of_features_to_activate.insert( f );
-                  if( res.second ) {
-                     protocol_features_to_activate.push_back( f );
-                  }
-               }
-               features_to_activate.clear();
-            }
-            std::swap( features_to_activate, protocol_features_to_activate );
-            _protocol_features_signaled = true;
-            ilog( "signaling activation of the following protocol features in block ${num}: ${features_to_activate}",
-                  ("num", hbs->block_num + 1)("features_to_activate", features_to_activate) );
-         }
+      if( _pending_block_mode == pending_block_mode::producing && is_pre_assembled( pre_assembled, block_time ) ) {
+         fc_dlog(_log, "Producing pre-assembled block #${n} with ${c} transactions",
+                 ("n", hbs->block_num + 1)("c", chain.get_pending_trx_receipts().size()));
+      } else {
+         start_pending_block( hbs, block_time, blocks_to_confirm );
       }
 
-      chain.start_block( block_time, blocks_to_confirm, features_to_activate );
+      if( pre_assemble )
+         _pre_assembled_block = pre_assembled_block{ block_time, hbs->id };
    } LOG_AND_DROP();
 
    if( chain.is_building_block() ) {
       const auto& pending_block_signing_authority = chain.pending_block_signing_authority();
-      const fc::time_point preprocess_deadline = calculate_block_deadline(block_time);
+      const fc::time_point preprocess_deadline = pre_assemble ? pre_assemble_deadline : calculate_block_deadline(block_time);
 
       if (_pending_block_mode == pending_block_mode::producing && pending_block_signing_authority != scheduled_producer.authority) {
          elog("Unexpected block signing authority, reverting to speculative mode! [expected: \"${expected}\", actual: \"${actual\"", ("expected", scheduled_producer.authority)("actual", pending_block_signing_authority));
@@ -1701,14 +2073,15 @@ bool producer_plugin_impl::remove_expired_blacklisted_trxs( const fc::time_point
 bool producer_plugin_impl::process_unapplied_trxs( const fc::time_point& deadline )
 {
    bool exhausted = false;
+   // a pre-assembled block is speculative until its window opens but is the block we will produce
+   const bool filling_block = _pending_block_mode == pending_block_mode::producing || _pre_assembled_block;
    if( !_unapplied_transactions.empty() ) {
       chain::controller& chain = chain_plug->chain();
-      int num_applied = 0, num_failed = 0, num_processed = 0;
+      int num_applied = 0, num_failed = 0, num_processed = 0, num_skipped = 0;
       auto unapplied_trxs_size = _unapplied_transactions.size();
-      auto itr     = (_pending_block_mode == pending_block_mode::producing) ?
-                     _unapplied_transactions.begin() : _unapplied_transactions.persisted_begin();
-      auto end_itr = (_pending_block_mode == pending_block_mode::producing) ?
-                     _unapplied_transactions.end()   : _unapplied_transactions.persisted_end();
+      const bool skip_untouched = _reapply_touched_trxs_only && _touched_accounts_complete && !filling_block;
+      auto itr     = filling_block ? _unapplied_transactions.begin() : _unapplied_transactions.persisted_begin();
+      auto end_itr = filling_block ? _unapplied_transactions.end()   : _unapplied_transactions.persisted_end();
       while( itr != end_itr ) {
          if( deadline <= fc::time_point::now() ) {
             exhausted = true;
@@ -1717,6 +2090,14 @@ bool producer_plugin_impl::process_unapplied_trxs( const fc::time_point& deadlin
 
          const transaction_metadata_ptr trx = itr->trx_meta;
          ++num_processed;
+         // re-running would see the same tracked state it saw last time; keep it queued for when we produce. This is
+         // lossy, the speculative block leaves it out until then. Already included in a block, let it run and be
+         // dropped as a duplicate.
+         if( skip_untouched && itr->untouched_by( _touched_accounts ) && !chain.is_known_unexpired_transaction( trx->id() ) ) {
+            ++num_skipped;
+            ++itr;
+            continue;
+         }
          try {
             auto trx_deadline = fc::time_point::now() + fc::milliseconds( _max_transaction_time_ms );
             bool deadline_is_subjective = false;
@@ -1749,8 +2130,13 @@ bool producer_plugin_impl::process_unapplied_trxs( const fc::time_point& deadlin
          ++itr;
       }
 
-      fc_dlog( _log, "Processed ${m} of ${n} previously applied transactions, Applied ${applied}, Failed/Dropped ${failed}",
-               ("m", num_processed)( "n", unapplied_trxs_size )("applied", num_applied)("failed", num_failed) );
+      fc_dlog( _log, "Processed ${m} of ${n} previously applied transactions, Applied ${applied}, Failed/Dropped ${failed}, Skipped ${skipped}",
+               ("m", num_processed)( "n", unapplied_trxs_size )("applied", num_applied)("failed", num_failed)("skipped", num_skipped) );
+   }
+   if( _reapply_touched_trxs_only && !exhausted ) {
+      // a block we produce is not seen by on_applied_transaction, so after producing every footprint is stale
+      _touched_accounts.clear();
+      _touched_accounts_complete = !filling_block;
    }
    return !exhausted;
 }
@@ -1922,8 +2308,8 @@ void producer_plugin_impl::schedule_production_loop() {
          // nothing to do until more blocks arrive
       }
 
-   } else if (result == start_block_result::waiting_for_production) {
-      // scheduled in start_block()
+   } else if (result == start_block_result::waiting_for_production || _pre_assembled_block) {
+      // scheduled in start_block(), a pre-assembled block is produced when its production window opens
 
    } else if (_pending_block_mode == pending_block_mode::producing) {
       schedule_maybe_produce_block( result == start_block_result::exhausted );
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <eosio/state_history_plugin/state_history_serialization.hpp>
+
+namespace eosio {
+
+// Filtering walks just enough of the serialized traces and deltas (see state_history_serialization.hpp) to find
+// each transaction's actions and each contract row's code, scope and table; kept records are copied unchanged.
+namespace history_filter {
+using stream = fc::datastream<const char*>;
+
+template <typename T>
+T read(stream& ds) {
+   T v;
+   fc::raw::unpack(ds, v);
+   return v;
+}
+
+inline void skip(stream& ds, uint64_t n) {
+   EOS_ASSERT(n <= ds.remaining(), chain::plugin_exception, "malformed state history entry");
+   ds.skip(n);
+}
+
+inline void skip_bytes(stream& ds) { skip(ds, read<fc::unsigned_int>(ds).value); }
+
+template <uint64_t Size>
+void skip_array(stream& ds) {
+   skip(ds, uint64_t(read<fc::unsigned_int>(ds).value) * Size);
+}
+
+inline bool matches(chain::name filter, uint64_t value) { return filter.empty() || filter.to_uint64_t() == value; }
+
+inline bool action_matches(stream& ds, const std::vector<action_filter>& filters) {
+   read<fc::unsigned_int>(ds);       // action_trace_v0
+   read<fc::unsigned_int>(ds);       // action_ordinal
+   read<fc::unsigned_int>(ds);       // creator_action_ordinal
+   if (read<bool>(ds)) {             // receipt
+      read<fc::unsigned_int>(ds);    // action_receipt_v0
+      skip(ds, 8 + 32 + 8 + 8);      // receiver, act_digest, global_sequence, recv_sequence
+      skip_array<16>(ds);            // auth_sequence
+      read<fc::unsigned_int>(ds);    // code_sequence
+      read<fc::unsigned_int>(ds);    // abi_sequence
+   }
+   auto receiver = read<uint64_t>(ds);
+   auto account  = read<uint64_t>(ds);
+   auto action   = read<uint64_t>(ds);
+   skip_array<16>(ds);               // authorization
+   skip_bytes(ds);                   // data
+   skip(ds, 1 + 8);                  // context_free, elapsed
+   skip_bytes(ds);                   // console
+   skip_array<16>(ds);               // account_ram_deltas
+   if (read<bool>(ds))               // except
+      skip_bytes(ds);
+   if (read<bool>(ds))               // error_code
+      skip(ds, 8);
+   for (auto& f : filters)
+      if (matches(f.receiver, receiver) && matches(f.account, account) && matches(f.action, action))
+         return true;
+   return false;
+}
+
+// consumes one transaction_trace, true if it or its failed deferred transaction has a matching action
+inline bool transaction_matches(stream& ds, const std::vector<action_filter>& filters) {
+   bool result = false;
+   read<fc::unsigned_int>(ds);       // transaction_trace_v0
+   skip(ds, 32 + 1 + 4);             // id, status, cpu_usage_us
+   read<fc::unsigned_int>(ds);       // net_usage_words
+   skip(ds, 8 + 8 + 1);              // elapsed, net_usage, scheduled
+   for (uint32_t n = read<fc::unsigned_int>(ds); n; --n)
+      result |= action_matches(ds, filters);
+   if (read<bool>(ds))               // account_ram_delta
+      skip(ds, 16);
+   if (read<bool>(ds))               // except
+      skip_bytes(ds);
+   if (read<bool>(ds))               // error_code
+      skip(ds, 8);
+   if (read<bool>(ds))               // failed_dtrx_trace
+      result |= transaction_matches(ds, filters);
+   if (read<bool>(ds)) {             // partial
+      read<fc::unsigned_int>(ds);    // partial_transaction_v0
+      skip(ds, 4 + 2 + 4);           // expiration, ref_block_num, ref_block_prefix
+      read<fc::unsigned_int>(ds);    // max_net_usage_words
+      skip(ds, 1);                   // max_cpu_usage_ms
+      read<fc::unsigned_int>(ds);    // delay_sec
+      read<chain::extensions_type>(ds);
+      read<std::vector<chain::signature_type>>(ds);
+      for (uint32_t n = read<fc::unsigned_int>(ds); n; --n) // context_free_data
+         skip_bytes(ds);
+   }
+   return result;
+}
+
+inline bytes filter_traces(const bytes& traces, const std::vector<action_filter>& filters) {
+   stream                                      ds(traces.data(), traces.size());
+   std::vector<std::pair<const char*, size_t>> kept;
+   for (uint32_t n = read<fc::unsigned_int>(ds); n; --n) {
+      auto begin = ds.pos();
+      if (transaction_matches(ds, filters))
+         kept.emplace_back(begin, ds.pos() - begin);
+   }
+   bytes result = fc::raw::pack(fc::unsigned_int(kept.size()));
+   for (auto& k : kept)
+      result.insert(result.end(), k.first, k.first + k.second);
+   return result;
+}
+
+// contract_table and all contract_* rows start with the struct version, code, scope and table
+inline bool row_matches(const bytes& row, const std::vector<table_filter>& filters) {
+   stream ds(row.data(), row.size());
+   read<fc::unsigned_int>(ds);
+   auto code  = read<uint64_t>(ds);
+   auto scope = read<uint64_t>(ds);
+   auto table = read<uint64_t>(ds);
+   for (auto& f : filters)
+      if (matches(f.code, code) && matches(f.scope, scope) && matches(f.table, table))
+         return true;
+   return false;
+}
+
+inline bytes filter_deltas(const bytes& deltas, const std::vector<table_filter>& filters) {
+   stream                   ds(deltas.data(), deltas.size());
+   std::vector<table_delta> result;
+   for (uint32_t n = read<fc::unsigned_int>(ds); n; --n) {
+      table_delta delta;
+      delta.struct_version = read<fc::unsigned_int>(ds);
+      delta.name           = read<std::string>(ds);
+      bool     contract    = delta.name.compare(0, 9, "contract_") == 0;
+      uint32_t num_rows    = read<fc::unsigned_int>(ds);
+      for (uint32_t i = 0; i < num_rows; ++i) {
+         auto present = read<bool>(ds);
+         auto row     = read<bytes>(ds);
+         if (!contract || row_matches(row, filters))
+            delta.rows.obj.emplace_back(present, std::move(row));
+      }
+      if (!delta.rows.obj.empty() || !num_rows)
+         result.push_back(std::move(delta));
+   }
+   return fc::raw::pack(result);
+}
+} // namespace history_filter
+} // namespace eosio
@@ -1,13 +1,17 @@
 #pragma once
 
 #include <boost/filesystem.hpp>
+#include <atomic>
 #include <fstream>
+#include <mutex>
 #include <stdint.h>
+#include <thread>
 
 #include <eosio/chain/block_header.hpp>
 #include <eosio/chain/exceptions.hpp>
 #include <eosio/chain/types.hpp>
 #include <fc/log/logger.hpp>
+#include <fc/log/logger_config.hpp> //set_os_thread_name()
 #include <fc/io/cfile.hpp>
 
 namespace eosio {
@@ -26,6 +30,12 @@ namespace eosio {
  * each entry:
  *    state_history_log_header
  *    payload
+ *
+ * With retain_blocks set, once the log holds retain_blocks / 2 blocks more than retain_blocks the oldest entries
+ * are dropped by copying the retained ones into fresh *.log and *.index files. Positions are rewritten during the
+ * copy, so a pruned log has the same layout as one that started at the new first block. The copy runs on its own
+ * thread with its own file handles; the next write_entry after it finishes appends the few blocks written in the
+ * meantime and swaps the files in.
  */
 
 inline uint64_t       ship_magic(uint32_t version) { return N(ship).to_uint64_t() | version; }
@@ -52,19 +62,40 @@ class state_history_log {
    fc::cfile            index;
    uint32_t             _begin_block = 0;
    uint32_t             _end_block   = 0;
+   uint32_t             retain_blocks = 0; // 0 keeps everything
    chain::block_id_type last_block_id;
+   mutable std::mutex   mx; // entries are read by session threads while the main thread writes
+
+   // set by start_prune() before prune_thread starts and left alone until it is joined
+   std::thread          prune_thread;
+   uint32_t             prune_begin_block = 0; // first block kept
+   uint32_t             prune_copy_end    = 0; // prune_thread copies [prune_begin_block, prune_copy_end)
+   bool                 prune_ok          = false;
+   std::atomic<bool>    prune_done{false};
+   std::atomic<bool>    prune_abort{false};
 
  public:
-   state_history_log(const char* const name, std::string log_filename, std::string index_filename)
+   state_history_log(const char* const name, std::string log_filename, std::string index_filename,
+                     uint32_t retain_blocks = 0)
        : name(name)
        , log_filename(std::move(log_filename))
-       , index_filename(std::move(index_filename)) {
+       , index_filename(std::move(index_filename))
+       , retain_blocks(retain_blocks) {
       open_log();
       open_index();
+      prune_if_needed();
    }
 
-   uint32_t begin_block() const { return _begin_block; }
-   uint32_t end_block() const { return _end_block; }
+   ~state_history_log() { cancel_prune(); }
+
+   uint32_t begin_block() const {
+      std::lock_guard<std::mutex> g(mx);
+      return _begin_block;
+   }
+   uint32_t end_block() const {
+      std::lock_guard<std::mutex> g(mx);
+      return _end_block;
+   }
 
    void read_header(state_history_log_header& header, bool assert_version = true) {
       char bytes[state_history_log_header_serial_size];
@@ -87,6 +118,7 @@ class state_history_log {
 
    template <typename F>
    void write_entry(const state_history_log_header& header, const chain::block_id_type& prev_id, F write_payload) {
+      std::lock_guard<std::mutex> g(mx);
       auto block_num = chain::block_header::num_from_id(header.block_id);
       EOS_ASSERT(_begin_block == _end_block || block_num <= _end_block, chain::plugin_exception,
                  "missed a block in ${name}.log", ("name", name));
@@ -97,7 +129,7 @@ class state_history_log {
                        ("name", name));
          } else {
             state_history_log_header prev;
-            get_entry(block_num - 1, prev);
+            seek_entry(block_num - 1, prev);
             EOS_ASSERT(prev_id == prev.block_id, chain::plugin_exception, "missed a fork change in ${name}.log",
                        ("name", name));
          }
@@ -120,10 +152,30 @@ class state_history_log {
          _begin_block = block_num;
       _end_block    = block_num + 1;
       last_block_id = header.block_id;
+      prune_if_needed();
+   }
+
+   // calls f(cfile positioned at payload, header) for the entry of block_num, returns false if it is not in the log
+   template <typename F>
+   bool read_entry(uint32_t block_num, F f) {
+      std::lock_guard<std::mutex> g(mx);
+      if (block_num < _begin_block || block_num >= _end_block)
+         return false;
+      state_history_log_header header;
+      auto&                    stream = seek_entry(block_num, header);
+      f(stream, header);
+      return true;
    }
 
+   fc::optional<chain::block_id_type> get_block_id(uint32_t block_num) {
+      fc::optional<chain::block_id_type> result;
+      read_entry(block_num, [&](fc::cfile&, const state_history_log_header& header) { result = header.block_id; });
+      return result;
+   }
+
+ private:
    // returns cfile positioned at payload
-   fc::cfile& get_entry(uint32_t block_num, state_history_log_header& header) {
+   fc::cfile& seek_entry(uint32_t block_num, state_history_log_header& header) {
       EOS_ASSERT(block_num >= _begin_block && block_num < _end_block, chain::plugin_exception,
                  "read non-existing block in ${name}.log", ("name", name));
       log.seek(get_pos(block_num));
@@ -131,13 +183,6 @@ class state_history_log {
       return log;
    }
 
-   chain::block_id_type get_block_id(uint32_t block_num) {
-      state_history_log_header header;
-      get_entry(block_num, header);
-      return header.block_id;
-   }
-
- private:
    bool get_last_block(uint64_t size) {
       state_history_log_header header;
       uint64_t                 suffix;
@@ -266,7 +311,148 @@ class state_history_log {
       return pos;
    }
 
+   void prune_if_needed() {
+      if (prune_thread.joinable()) {
+         if (prune_done)
+            finish_prune();
+         return;
+      }
+      if (retain_blocks && _end_block - _begin_block >= uint64_t(retain_blocks) + std::max(retain_blocks / 2, 1u))
+         start_prune(_end_block - retain_blocks);
+   }
+
+   // keeps [new_begin_block, _end_block); the bulk of the copy runs on prune_thread
+   void start_prune(uint32_t new_begin_block) {
+      log.flush();
+      index.flush();
+      prune_begin_block = new_begin_block;
+      prune_copy_end    = _end_block;
+      prune_ok          = false;
+      prune_done        = false;
+      prune_abort       = false;
+      prune_thread      = std::thread([this, old_begin_block = _begin_block]() {
+         fc::set_os_thread_name("shipprune");
+         copy_retained(old_begin_block);
+         prune_done = true;
+      });
+   }
+
+   // prune_thread: only reads the flushed part of the log, which is not modified until the prune is joined
+   void copy_retained(uint32_t old_begin_block) {
+      try {
+         fc::cfile old_log;
+         fc::cfile old_index;
+         fc::cfile new_log;
+         fc::cfile new_index;
+         old_log.set_file_path(log_filename);
+         old_index.set_file_path(index_filename);
+         new_log.set_file_path(log_filename + ".prune");
+         new_index.set_file_path(index_filename + ".prune");
+         old_log.open("rb");
+         old_index.open("rb");
+         new_log.open("w+b");
+         new_index.open("w+b");
+
+         std::vector<char> buffer(1024 * 1024);
+         old_index.seek((prune_begin_block - old_begin_block) * sizeof(uint64_t));
+         for (uint32_t block_num = prune_begin_block; block_num < prune_copy_end; ++block_num) {
+            if (prune_abort)
+               return;
+            uint64_t pos;
+            old_index.read((char*)&pos, sizeof(pos));
+            uint64_t new_pos = copy_entry(old_log, pos, new_log, buffer);
+            new_index.write((char*)&new_pos, sizeof(new_pos));
+         }
+         new_log.close();
+         new_index.close();
+         prune_ok = true;
+      } catch (const fc::exception& e) {
+         elog("pruning ${name}.log failed: ${e}", ("name", name)("e", e.to_detail_string()));
+      } catch (const std::exception& e) {
+         elog("pruning ${name}.log failed: ${e}", ("name", name)("e", e.what()));
+      }
+   }
+
+   // copies the entry at pos to the end of to, returns its new position
+   uint64_t copy_entry(fc::cfile& from, uint64_t pos, fc::cfile& to, std::vector<char>& buffer) const {
+      char bytes[state_history_log_header_serial_size];
+      from.seek(pos);
+      from.read(bytes, sizeof(bytes));
+      state_history_log_header    header;
+      fc::datastream<const char*> ds(bytes, sizeof(bytes));
+      fc::raw::unpack(ds, header);
+      EOS_ASSERT(is_ship(header.magic) && is_ship_supported_version(header.magic), chain::plugin_exception,
+                 "corrupt ${name}.log (9)", ("name", name));
+
+      uint64_t new_pos = to.tellp();
+      to.write(bytes, sizeof(bytes));
+      for (uint64_t remaining = header.payload_size; remaining;) {
+         auto n = std::min<uint64_t>(remaining, buffer.size());
+         from.read(buffer.data(), n);
+         to.write(buffer.data(), n);
+         remaining -= n;
+      }
+      to.write((char*)&new_pos, sizeof(new_pos));
+      return new_pos;
+   }
+
+   // appends the blocks written since start_prune() and swaps the pruned files in
+   void finish_prune() {
+      prune_thread.join();
+      if (!prune_ok) {
+         remove_prune_files();
+         return; // retried on the next write
+      }
+
+      log.flush();
+      index.flush();
+      fc::cfile new_log;
+      fc::cfile new_index;
+      new_log.set_file_path(log_filename + ".prune");
+      new_index.set_file_path(index_filename + ".prune");
+      new_log.open("a+b");
+      new_index.open("a+b");
+      new_log.seek_end(0);
+      new_index.seek_end(0);
+      std::vector<char> buffer(1024 * 1024);
+      for (uint32_t block_num = prune_copy_end; block_num < _end_block; ++block_num) {
+         uint64_t new_pos = copy_entry(log, get_pos(block_num), new_log, buffer);
+         new_index.write((char*)&new_pos, sizeof(new_pos));
+      }
+      new_log.close();
+      new_index.close();
+
+      // a crash between the renames leaves an index that open_index() notices and regenerates
+      log.close();
+      index.close();
+      boost::filesystem::rename(log_filename + ".prune", log_filename);
+      boost::filesystem::rename(index_filename + ".prune", index_filename);
+      log.open("a+b");
+      index.open("a+b");
+
+      ilog("pruned ${n} blocks from ${name}.log, now has blocks ${b}-${e}",
+           ("n", prune_begin_block - _begin_block)("name", name)("b", prune_begin_block)("e", _end_block - 1));
+      _begin_block = prune_begin_block;
+   }
+
+   // stops a running prune and throws its work away
+   void cancel_prune() {
+      if (!prune_thread.joinable())
+         return;
+      prune_abort = true;
+      prune_thread.join();
+      remove_prune_files();
+   }
+
+   void remove_prune_files() {
+      boost::system::error_code ec;
+      boost::filesystem::remove(log_filename + ".prune", ec);
+      boost::filesystem::remove(index_filename + ".prune", ec);
+   }
+
    void truncate(uint32_t block_num) {
+      if (block_num < prune_copy_end)
+         cancel_prune(); // the copied entries are being removed
       log.flush();
       index.flush();
       uint64_t num_removed = 0;
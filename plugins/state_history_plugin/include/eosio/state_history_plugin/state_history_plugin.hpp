@@ -98,6 +98,29 @@ struct get_blocks_request_v0 {
    bool                        fetch_deltas           = false;
 };
 
+struct get_blocks_request_v1 : get_blocks_request_v0 {
+   bool fetch_compressed = false; // traces and deltas as stored in the logs, zlib compressed
+};
+
+// an empty name matches anything
+struct action_filter {
+   chain::name receiver = {};
+   chain::name account  = {};
+   chain::name action   = {};
+};
+
+// an empty name matches anything
+struct table_filter {
+   chain::name code  = {};
+   chain::name scope = {};
+   chain::name table = {};
+};
+
+struct get_blocks_request_v2 : get_blocks_request_v1 {
+   std::vector<action_filter> trace_filters = {}; // keep transactions with at least one matching action; empty keeps all
+   std::vector<table_filter>  delta_filters = {}; // keep matching contract_* rows, other tables are untouched; empty keeps all
+};
+
 struct get_blocks_ack_request_v0 {
    uint32_t num_messages = 0;
 };
@@ -112,8 +135,12 @@ struct get_blocks_result_v0 {
    fc::optional<bytes>          deltas;
 };
 
-using state_request = fc::static_variant<get_status_request_v0, get_blocks_request_v0, get_blocks_ack_request_v0>;
-using state_result  = fc::static_variant<get_status_result_v0, get_blocks_result_v0>;
+struct get_blocks_result_v1 : get_blocks_result_v0 {
+   bool compressed = false; // traces and deltas are zlib compressed
+};
+
+using state_request = fc::static_variant<get_status_request_v0, get_blocks_request_v0, get_blocks_ack_request_v0, get_blocks_request_v1, get_blocks_request_v2>;
+using state_result  = fc::static_variant<get_status_result_v0, get_blocks_result_v0, get_blocks_result_v1>;
 
 class state_history_plugin : public plugin<state_history_plugin> {
  public:
@@ -140,5 +167,9 @@ FC_REFLECT(eosio::block_position, (block_num)(block_id));
 FC_REFLECT_EMPTY(eosio::get_status_request_v0);
 FC_REFLECT(eosio::get_status_result_v0, (head)(last_irreversible)(trace_begin_block)(trace_end_block)(chain_state_begin_block)(chain_state_end_block));
 FC_REFLECT(eosio::get_blocks_request_v0, (start_block_num)(end_block_num)(max_messages_in_flight)(have_positions)(irreversible_only)(fetch_block)(fetch_traces)(fetch_deltas));
+FC_REFLECT_DERIVED(eosio::get_blocks_request_v1, (eosio::get_blocks_request_v0), (fetch_compressed));
+FC_REFLECT(eosio::action_filter, (receiver)(account)(action));
+FC_REFLECT(eosio::table_filter, (code)(scope)(table));
+FC_REFLECT_DERIVED(eosio::get_blocks_request_v2, (eosio::get_blocks_request_v1), (trace_filters)(delta_filters));
 FC_REFLECT(eosio::get_blocks_ack_request_v0, (num_messages));
 // clang-format on
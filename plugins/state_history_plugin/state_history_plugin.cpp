@@ -1,7 +1,11 @@
 #include <eosio/chain/config.hpp>
+#include <eosio/chain/thread_utils.hpp>
+#include <eosio/state_history_plugin/history_filter.hpp>
 #include <eosio/state_history_plugin/state_history_log.hpp>
 #include <eosio/state_history_plugin/state_history_serialization.hpp>
 
+#include <fc/scoped_exit.hpp>
+
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/ip/host_name.hpp>
 #include <boost/asio/ip/tcp.hpp>
@@ -115,28 +119,52 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
    fc::optional<state_history_log>                            trace_log;
    fc::optional<state_history_log>                            chain_state_log;
    bool                                                       trace_debug_mode = false;
-   bool                                                       stopping = false;
+   std::atomic<bool>                                          stopping{false};
    fc::optional<scoped_connection>                            applied_transaction_connection;
    fc::optional<scoped_connection>                            accepted_block_connection;
    string                                                     endpoint_address = "0.0.0.0";
    uint16_t                                                   endpoint_port    = 8080;
+   uint16_t                                                   thread_pool_size = 2;
+   fc::optional<named_thread_pool>                            thread_pool;
    std::unique_ptr<tcp::acceptor>                             acceptor;
    std::map<transaction_id_type, augmented_transaction_trace> cached_traces;
    fc::optional<augmented_transaction_trace>                  onblock_trace;
 
-   void get_log_entry(state_history_log& log, uint32_t block_num, fc::optional<bytes>& result) {
-      if (block_num < log.begin_block() || block_num >= log.end_block())
+   // head and last irreversible block as of the last accepted block, published for the session threads
+   std::mutex     head_mtx;
+   block_position head;
+   block_position last_irreversible;
+
+   void set_head(const block_position& new_head, const block_position& new_lib) {
+      std::lock_guard<std::mutex> g(head_mtx);
+      head              = new_head;
+      last_irreversible = new_lib;
+   }
+
+   std::pair<block_position, block_position> get_head() {
+      std::lock_guard<std::mutex> g(head_mtx);
+      return {head, last_irreversible};
+   }
+
+   // the entry is stored zlib compressed, `decompress` false returns it as stored
+   void get_log_entry(state_history_log& log, uint32_t block_num, bool decompress, fc::optional<bytes>& result) {
+      bytes compressed;
+      bool  found = log.read_entry(block_num, [&](fc::cfile& stream, const state_history_log_header&) {
+         uint32_t s;
+         stream.read((char*)&s, sizeof(s));
+         compressed.resize(s);
+         if (s)
+            stream.read(compressed.data(), s);
+      });
+      if (!found)
          return;
-      state_history_log_header header;
-      auto&                    stream = log.get_entry(block_num, header);
-      uint32_t                 s;
-      stream.read((char*)&s, sizeof(s));
-      bytes compressed(s);
-      if (s)
-         stream.read(compressed.data(), s);
-      result = zlib_decompress(compressed);
+      if (decompress)
+         result = zlib_decompress(compressed);
+      else
+         result = std::move(compressed);
    }
 
+   // main thread only
    void get_block(uint32_t block_num, fc::optional<bytes>& result) {
       chain::signed_block_ptr p;
       try {
@@ -148,11 +176,21 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
          result = fc::raw::pack(*p);
    }
 
+   // safe from any thread, only consults the state history logs
+   fc::optional<chain::block_id_type> get_log_block_id(uint32_t block_num) {
+      fc::optional<chain::block_id_type> id;
+      if (trace_log)
+         id = trace_log->get_block_id(block_num);
+      if (!id && chain_state_log)
+         id = chain_state_log->get_block_id(block_num);
+      return id;
+   }
+
+   // main thread only, falls back to the block log
    fc::optional<chain::block_id_type> get_block_id(uint32_t block_num) {
-      if (trace_log && block_num >= trace_log->begin_block() && block_num < trace_log->end_block())
-         return trace_log->get_block_id(block_num);
-      if (chain_state_log && block_num >= chain_state_log->begin_block() && block_num < chain_state_log->end_block())
-         return chain_state_log->get_block_id(block_num);
+      auto id = get_log_block_id(block_num);
+      if (id)
+         return id;
       try {
          auto block = chain_plug->chain().fetch_block_by_number(block_num);
          if (block)
@@ -162,47 +200,59 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
       return {};
    }
 
+   // Sessions run on the state history thread pool, each serialized by its own strand. Anything that needs the
+   // controller (the block log) is done on the main thread via on_main_thread().
    struct session : std::enable_shared_from_this<session> {
-      std::shared_ptr<state_history_plugin_impl> plugin;
-      std::unique_ptr<ws::stream<tcp::socket>>   socket_stream;
-      bool                                       sending  = false;
-      bool                                       sent_abi = false;
-      std::vector<std::vector<char>>             send_queue;
-      fc::optional<get_blocks_request_v0>        current_request;
-      bool                                       need_to_send_update = false;
-
-      session(std::shared_ptr<state_history_plugin_impl> plugin)
-          : plugin(std::move(plugin)) {}
-
-      void start(tcp::socket socket) {
+      std::shared_ptr<state_history_plugin_impl>                  plugin;
+      std::unique_ptr<ws::stream<tcp::socket>>                    socket_stream;
+      boost::asio::strand<boost::asio::io_context::executor_type> strand;
+      bool                                                        sending  = false;
+      bool                                                        sent_abi = false;
+      std::vector<std::vector<char>>                              send_queue;
+      fc::optional<get_blocks_request_v2>                         current_request;
+      bool                                                        current_request_v1 = false; // reply with get_blocks_result_v1
+      bool                                                        need_to_send_update = false;
+      uint32_t                                                    fetching            = 0; // outstanding main thread lookups
+      uint64_t                                                    request_generation  = 0; // drops lookups for replaced requests
+      bool                                                        resolving_request   = false;
+      uint32_t                                                    pending_acks        = 0;
+
+      session(std::shared_ptr<state_history_plugin_impl> plugin, tcp::socket socket)
+          : plugin(std::move(plugin))
+          , socket_stream(std::make_unique<ws::stream<tcp::socket>>(std::move(socket)))
+          , strand(this->plugin->thread_pool->get_executor().get_executor()) {}
+
+      void start() {
          ilog("incoming connection");
-         socket_stream = std::make_unique<ws::stream<tcp::socket>>(std::move(socket));
          socket_stream->binary(true);
          socket_stream->next_layer().set_option(boost::asio::ip::tcp::no_delay(true));
          socket_stream->next_layer().set_option(boost::asio::socket_base::send_buffer_size(1024 * 1024));
          socket_stream->next_layer().set_option(boost::asio::socket_base::receive_buffer_size(1024 * 1024));
-         socket_stream->async_accept([self = shared_from_this()](boost::system::error_code ec) {
-            self->callback(ec, "async_accept", [self] {
-               self->start_read();
-               self->send(state_history_plugin_abi);
-            });
-         });
+         socket_stream->async_accept(
+             boost::asio::bind_executor(strand, [self = shared_from_this()](boost::system::error_code ec) {
+                self->callback(ec, "async_accept", [self] {
+                   self->start_read();
+                   self->send(state_history_plugin_abi);
+                });
+             }));
       }
 
       void start_read() {
          auto in_buffer = std::make_shared<boost::beast::flat_buffer>();
          socket_stream->async_read(
-             *in_buffer, [self = shared_from_this(), in_buffer](boost::system::error_code ec, size_t) {
-                self->callback(ec, "async_read", [self, in_buffer] {
-                   auto d = boost::asio::buffer_cast<char const*>(boost::beast::buffers_front(in_buffer->data()));
-                   auto s = boost::asio::buffer_size(in_buffer->data());
-                   fc::datastream<const char*> ds(d, s);
-                   state_request               req;
-                   fc::raw::unpack(ds, req);
-                   req.visit(*self);
-                   self->start_read();
-                });
-             });
+             *in_buffer,
+             boost::asio::bind_executor(
+                 strand, [self = shared_from_this(), in_buffer](boost::system::error_code ec, size_t) {
+                    self->callback(ec, "async_read", [self, in_buffer] {
+                       auto d = boost::asio::buffer_cast<char const*>(boost::beast::buffers_front(in_buffer->data()));
+                       auto s = boost::asio::buffer_size(in_buffer->data());
+                       fc::datastream<const char*> ds(d, s);
+                       state_request               req;
+                       fc::raw::unpack(ds, req);
+                       req.visit(*self);
+                       self->start_read();
+                    });
+                 }));
       }
 
       void send(const char* s) {
@@ -226,21 +276,39 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
          sent_abi = true;
          socket_stream->async_write( //
              boost::asio::buffer(send_queue[0]),
-             [self = shared_from_this()](boost::system::error_code ec, size_t) {
+             boost::asio::bind_executor(strand, [self = shared_from_this()](boost::system::error_code ec, size_t) {
                 self->callback(ec, "async_write", [self] {
                    self->send_queue.erase(self->send_queue.begin());
                    self->sending = false;
                    self->send();
                 });
-             });
+             }));
+      }
+
+      // runs f() on the main thread, then g(result) back on this session's strand
+      template <typename F, typename G>
+      void on_main_thread(F f, G g) {
+         ++fetching;
+         app().post(priority::medium, [self = shared_from_this(), f = std::move(f), g = std::move(g)]() mutable {
+            if (self->plugin->stopping)
+               return;
+            auto result = f();
+            boost::asio::post(self->strand, [self, result = std::move(result), g = std::move(g)]() mutable {
+               if (self->plugin->stopping)
+                  return;
+               --self->fetching;
+               self->catch_and_close([&] {
+                  g(std::move(result));
+                  self->send_update();
+               });
+            });
+         });
       }
 
       using result_type = void;
       void operator()(get_status_request_v0&) {
-         auto&                chain = plugin->chain_plug->chain();
          get_status_result_v0 result;
-         result.head              = {chain.head_block_num(), chain.head_block_id()};
-         result.last_irreversible = {chain.last_irreversible_block_num(), chain.last_irreversible_block_id()};
+         std::tie(result.head, result.last_irreversible) = plugin->get_head();
          if (plugin->trace_log) {
             result.trace_begin_block = plugin->trace_log->begin_block();
             result.trace_end_block   = plugin->trace_log->end_block();
@@ -253,75 +321,165 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
       }
 
       void operator()(get_blocks_request_v0& req) {
+         get_blocks_request_v2 req_v2;
+         static_cast<get_blocks_request_v0&>(req_v2) = std::move(req);
+         start_blocks_request(std::move(req_v2), false);
+      }
+
+      void operator()(get_blocks_request_v1& req) {
+         get_blocks_request_v2 req_v2;
+         static_cast<get_blocks_request_v1&>(req_v2) = std::move(req);
+         start_blocks_request(std::move(req_v2), true);
+      }
+
+      void operator()(get_blocks_request_v2& req) { start_blocks_request(std::move(req), true); }
+
+      void start_blocks_request(get_blocks_request_v2 req, bool v1) {
+         std::vector<block_position> unresolved;
          for (auto& cp : req.have_positions) {
             if (req.start_block_num <= cp.block_num)
                continue;
-            auto id = plugin->get_block_id(cp.block_num);
-            if (!id || *id != cp.block_id)
+            auto id = plugin->get_log_block_id(cp.block_num);
+            if (!id)
+               unresolved.push_back(cp);
+            else if (*id != cp.block_id)
                req.start_block_num = std::min(req.start_block_num, cp.block_num);
          }
          req.have_positions.clear();
-         current_request = req;
+         current_request.reset();
+         pending_acks = 0;
+         auto generation = ++request_generation;
+         if (unresolved.empty())
+            return set_request(std::move(req), v1);
+
+         // positions older than the state history logs can only be checked against the block log
+         resolving_request    = true;
+         auto start_block_num = req.start_block_num;
+         on_main_thread(
+             [plugin = plugin, unresolved = std::move(unresolved), start_block_num] {
+                auto result = start_block_num;
+                for (auto& cp : unresolved) {
+                   auto id = plugin->get_block_id(cp.block_num);
+                   if (!id || *id != cp.block_id)
+                      result = std::min(result, cp.block_num);
+                }
+                return result;
+             },
+             [this, generation, req = std::move(req), v1](uint32_t start_block_num) mutable {
+                if (generation != request_generation)
+                   return;
+                req.start_block_num = start_block_num;
+                set_request(std::move(req), v1);
+             });
+      }
+
+      void set_request(get_blocks_request_v2 req, bool v1) {
+         req.max_messages_in_flight += pending_acks;
+         pending_acks       = 0;
+         resolving_request  = false;
+         current_request    = std::move(req);
+         current_request_v1 = v1;
          send_update(true);
       }
 
       void operator()(get_blocks_ack_request_v0& req) {
-         if (!current_request)
+         if (!current_request) {
+            if (resolving_request)
+               pending_acks += req.num_messages;
             return;
+         }
          current_request->max_messages_in_flight += req.num_messages;
          send_update();
       }
 
-      void send_update(get_blocks_result_v0 result) {
-         need_to_send_update = true;
-         if (!send_queue.empty() || !current_request || !current_request->max_messages_in_flight)
+      // main thread lookups for a block that is not (fully) covered by the state history logs
+      struct block_log_result {
+         fc::optional<chain::block_id_type> block_id;
+         fc::optional<chain::block_id_type> prev_block_id;
+         fc::optional<bytes>                block;
+      };
+
+      void send_update(bool changed = false) {
+         if (changed)
+            need_to_send_update = true;
+         if (fetching || !send_queue.empty() || !need_to_send_update || !current_request ||
+             !current_request->max_messages_in_flight)
             return;
-         auto& chain = plugin->chain_plug->chain();
-         result.last_irreversible = {chain.last_irreversible_block_num(), chain.last_irreversible_block_id()};
+         get_blocks_result_v1 result;
+         std::tie(result.head, result.last_irreversible) = plugin->get_head();
          uint32_t current =
                current_request->irreversible_only ? result.last_irreversible.block_num : result.head.block_num;
          if (current_request->start_block_num <= current &&
              current_request->start_block_num < current_request->end_block_num) {
-            auto block_id = plugin->get_block_id(current_request->start_block_num);
-            if (block_id) {
-               result.this_block  = block_position{current_request->start_block_num, *block_id};
-               auto prev_block_id = plugin->get_block_id(current_request->start_block_num - 1);
-               if (prev_block_id)
-                  result.prev_block = block_position{current_request->start_block_num - 1, *prev_block_id};
-               if (current_request->fetch_block)
-                  plugin->get_block(current_request->start_block_num, result.block);
-               if (current_request->fetch_traces && plugin->trace_log)
-                  plugin->get_log_entry(*plugin->trace_log, current_request->start_block_num, result.traces);
-               if (current_request->fetch_deltas && plugin->chain_state_log)
-                  plugin->get_log_entry(*plugin->chain_state_log, current_request->start_block_num, result.deltas);
+            auto block_num     = current_request->start_block_num++;
+            auto block_id      = plugin->get_log_block_id(block_num);
+            auto prev_block_id = plugin->get_log_block_id(block_num - 1);
+            const bool decompress = !current_request->fetch_compressed;
+            auto get_entry = [&](state_history_log& log, const auto& filters, auto filter, fc::optional<bytes>& entry) {
+               plugin->get_log_entry(log, block_num, decompress || !filters.empty(), entry);
+               if (!entry || filters.empty())
+                  return;
+               entry = filter(*entry, filters);
+               if (!decompress)
+                  entry = zlib_compress_bytes(std::move(*entry));
+            };
+            if (current_request->fetch_traces && plugin->trace_log)
+               get_entry(*plugin->trace_log, current_request->trace_filters, history_filter::filter_traces,
+                         result.traces);
+            if (current_request->fetch_deltas && plugin->chain_state_log)
+               get_entry(*plugin->chain_state_log, current_request->delta_filters, history_filter::filter_deltas,
+                         result.deltas);
+            result.compressed = !decompress;
+
+            if (!block_id || !prev_block_id || current_request->fetch_block) {
+               auto generation = request_generation;
+               return on_main_thread(
+                   [plugin = plugin, block_num, block_id, prev_block_id, fetch_block = current_request->fetch_block] {
+                      block_log_result r{block_id, prev_block_id};
+                      if (!r.block_id)
+                         r.block_id = plugin->get_block_id(block_num);
+                      if (r.block_id && !r.prev_block_id)
+                         r.prev_block_id = plugin->get_block_id(block_num - 1);
+                      if (r.block_id && fetch_block)
+                         plugin->get_block(block_num, r.block);
+                      return r;
+                   },
+                   [this, generation, block_num, result = std::move(result)](block_log_result r) mutable {
+                      if (generation != request_generation)
+                         return;
+                      if (r.block_id) {
+                         result.this_block = block_position{block_num, *r.block_id};
+                         if (r.prev_block_id)
+                            result.prev_block = block_position{block_num - 1, *r.prev_block_id};
+                         result.block = std::move(r.block);
+                      }
+                      finish_update(std::move(result));
+                   });
             }
-            ++current_request->start_block_num;
+            result.this_block = block_position{block_num, *block_id};
+            result.prev_block = block_position{block_num - 1, *prev_block_id};
          }
-         send(std::move(result));
+         finish_update(std::move(result));
+      }
+
+      void finish_update(get_blocks_result_v1 result) {
+         uint32_t current =
+               current_request->irreversible_only ? result.last_irreversible.block_num : result.head.block_num;
+         if (current_request_v1)
+            send(std::move(result));
+         else
+            send(static_cast<get_blocks_result_v0&&>(result));
          --current_request->max_messages_in_flight;
          need_to_send_update = current_request->start_block_num <= current &&
                                current_request->start_block_num < current_request->end_block_num;
       }
 
-      void send_update(const block_state_ptr& block_state) {
-         need_to_send_update = true;
-         if (!send_queue.empty() || !current_request || !current_request->max_messages_in_flight)
-            return;
-         get_blocks_result_v0 result;
-         result.head = {block_state->block_num, block_state->id};
-         send_update(std::move(result));
-      }
-
-      void send_update(bool changed = false) {
-         if (changed)
-            need_to_send_update = true;
-         if (!send_queue.empty() || !need_to_send_update || !current_request ||
-             !current_request->max_messages_in_flight)
-            return;
-         auto& chain = plugin->chain_plug->chain();
-         get_blocks_result_v0 result;
-         result.head = {chain.head_block_num(), chain.head_block_id()};
-         send_update(std::move(result));
+      void on_accepted_block(uint32_t block_num) {
+         catch_and_close([&] {
+            if (current_request && block_num < current_request->start_block_num)
+               current_request->start_block_num = block_num;
+            send_update(true);
+         });
       }
 
       template <typename F>
@@ -340,15 +498,14 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
          }
       }
 
+      // handlers are bound to the strand, so this already runs on it
       template <typename F>
       void callback(boost::system::error_code ec, const char* what, F f) {
-         app().post( priority::medium, [=]() {
-            if( plugin->stopping )
-               return;
-            if( ec )
-               return on_fail( ec, what );
-            catch_and_close( f );
-         } );
+         if (plugin->stopping)
+            return;
+         if (ec)
+            return on_fail(ec, what);
+         catch_and_close(f);
       }
 
       void on_fail(boost::system::error_code ec, const char* what) {
@@ -361,10 +518,13 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
       }
 
       void close() {
-         socket_stream->next_layer().close();
+         boost::system::error_code ec;
+         socket_stream->next_layer().close(ec);
+         std::lock_guard<std::mutex> g(plugin->sessions_mtx);
          plugin->sessions.erase(this);
       }
    };
+   std::mutex                                   sessions_mtx;
    std::map<session*, std::shared_ptr<session>> sessions;
 
    void listen() {
@@ -372,7 +532,7 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
 
       auto address  = boost::asio::ip::make_address(endpoint_address);
       auto endpoint = tcp::endpoint{address, endpoint_port};
-      acceptor      = std::make_unique<tcp::acceptor>(app().get_io_service());
+      acceptor      = std::make_unique<tcp::acceptor>(thread_pool->get_executor());
 
       auto check_ec = [&](const char* what) {
          if (!ec)
@@ -392,7 +552,7 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
    }
 
    void do_accept() {
-      auto socket = std::make_shared<tcp::socket>(app().get_io_service());
+      auto socket = std::make_shared<tcp::socket>(thread_pool->get_executor());
       acceptor->async_accept(*socket, [self = shared_from_this(), socket, this](const boost::system::error_code& ec) {
          if (stopping)
             return;
@@ -402,9 +562,12 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
             return;
          }
          catch_and_log([&] {
-            auto s            = std::make_shared<session>(self);
-            sessions[s.get()] = s;
-            s->start(std::move(*socket));
+            auto s = std::make_shared<session>(self, std::move(*socket));
+            {
+               std::lock_guard<std::mutex> g(sessions_mtx);
+               sessions[s.get()] = s;
+            }
+            boost::asio::post(s->strand, [s] { s->catch_and_close([&] { s->start(); }); });
          });
          catch_and_log([&] { do_accept(); });
       });
@@ -436,14 +599,20 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
    void on_accepted_block(const block_state_ptr& block_state) {
       store_traces(block_state);
       store_chain_state(block_state);
-      for (auto& s : sessions) {
-         auto& p = s.second;
-         if (p) {
-            if (p->current_request && block_state->block_num < p->current_request->start_block_num)
-               p->current_request->start_block_num = block_state->block_num;
-            p->send_update(block_state);
-         }
+      auto& chain = chain_plug->chain();
+      set_head({block_state->block_num, block_state->id},
+               {chain.last_irreversible_block_num(), chain.last_irreversible_block_id()});
+      std::vector<std::shared_ptr<session>> to_notify;
+      {
+         std::lock_guard<std::mutex> g(sessions_mtx);
+         for (auto& s : sessions)
+            to_notify.push_back(s.second);
       }
+      for (auto& s : to_notify)
+         boost::asio::post(s->strand, [s, block_num = block_state->block_num] {
+            if (!s->plugin->stopping)
+               s->on_accepted_block(block_num);
+         });
    }
 
    void store_traces(const block_state_ptr& block_state) {
@@ -511,35 +680,49 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
          return fc::raw::pack(make_history_context_wrapper(db, get_table_id(row.t_id._id), row));
       };
 
+      // Each changed table is packed on the thread pool. The main thread blocks on the results below, so the
+      // database is not modified while the workers read it; deltas keep the order the tables are listed in.
+      // The tasks reference the index, its undo state and the pack lambdas, so however this function is left
+      // every task still queued or running is waited for first.
+      std::vector<std::future<table_delta>> pending;
+      auto wait_for_pending = fc::make_scoped_exit([&pending] {
+         for (auto& f : pending)
+            if (f.valid())
+               f.wait();
+      });
       auto process_table = [&](auto* name, auto& index, auto& pack_row) {
          if (fresh) {
             if (index.indices().empty())
                return;
-            deltas.push_back({});
-            auto& delta = deltas.back();
-            delta.name  = name;
-            for (auto& row : index.indices())
-               delta.rows.obj.emplace_back(true, pack_row(row));
+            pending.push_back(async_thread_pool(thread_pool->get_executor(), [name, &index, &pack_row] {
+               table_delta delta;
+               delta.name = name;
+               for (auto& row : index.indices())
+                  delta.rows.obj.emplace_back(true, pack_row(row));
+               return delta;
+            }));
          } else {
             if (index.stack().empty())
                return;
             auto& undo = index.stack().back();
             if (undo.old_values.empty() && undo.new_ids.empty() && undo.removed_values.empty())
                return;
-            deltas.push_back({});
-            auto& delta = deltas.back();
-            delta.name  = name;
-            for (auto& old : undo.old_values) {
-               auto& row = index.get(old.first);
-               if (include_delta(old.second, row))
+            pending.push_back(async_thread_pool(thread_pool->get_executor(), [name, &index, &undo, &pack_row] {
+               table_delta delta;
+               delta.name = name;
+               for (auto& old : undo.old_values) {
+                  auto& row = index.get(old.first);
+                  if (include_delta(old.second, row))
+                     delta.rows.obj.emplace_back(true, pack_row(row));
+               }
+               for (auto& old : undo.removed_values)
+                  delta.rows.obj.emplace_back(false, pack_row(old.second));
+               for (auto id : undo.new_ids) {
+                  auto& row = index.get(id);
                   delta.rows.obj.emplace_back(true, pack_row(row));
-            }
-            for (auto& old : undo.removed_values)
-               delta.rows.obj.emplace_back(false, pack_row(old.second));
-            for (auto id : undo.new_ids) {
-               auto& row = index.get(id);
-               delta.rows.obj.emplace_back(true, pack_row(row));
-            }
+               }
+               return delta;
+            }));
          }
       };
 
@@ -567,6 +750,10 @@ struct state_history_plugin_impl : std::enable_shared_from_this<state_history_pl
       process_table("resource_limits_state", db.get_index<resource_limits::resource_limits_state_index>(), pack_row);
       process_table("resource_limits_config", db.get_index<resource_limits::resource_limits_config_index>(), pack_row);
 
+      deltas.reserve(pending.size());
+      for (auto& f : pending)
+         deltas.push_back(f.get());
+
       auto deltas_bin = zlib_compress_bytes(fc::raw::pack(deltas));
       EOS_ASSERT(deltas_bin.size() == (uint32_t)deltas_bin.size(), plugin_exception, "deltas is too big");
       state_history_log_header header{.magic        = ship_magic(ship_current_version),
@@ -598,6 +785,11 @@ void state_history_plugin::set_program_options(options_description& cli, options
            "your internal network.");
    options("trace-history-debug-mode", bpo::bool_switch()->default_value(false),
            "enable debug mode for trace history");
+   options("state-history-log-retain-blocks", bpo::value<uint32_t>()->default_value(0),
+           "if non-zero, keep at least this many of the most recent blocks in the state history logs and prune "
+           "older ones");
+   options("state-history-threads", bpo::value<uint16_t>()->default_value(2),
+           "number of threads serving state history websocket sessions and packing chain state deltas");
 }
 
 void state_history_plugin::plugin_initialize(const variables_map& options) {
@@ -639,24 +831,42 @@ void state_history_plugin::plugin_initialize(const variables_map& options) {
          my->trace_debug_mode = true;
       }
 
+      my->thread_pool_size = options.at("state-history-threads").as<uint16_t>();
+      EOS_ASSERT(my->thread_pool_size > 0, plugin_config_exception,
+                 "state-history-threads ${num} must be greater than 0", ("num", my->thread_pool_size));
+      // created here rather than at startup, chain state deltas are also packed on it during replay
+      my->thread_pool.emplace("ship", my->thread_pool_size);
+
+      auto retain_blocks = options.at("state-history-log-retain-blocks").as<uint32_t>();
       if (options.at("trace-history").as<bool>())
          my->trace_log.emplace("trace_history", (state_history_dir / "trace_history.log").string(),
-                               (state_history_dir / "trace_history.index").string());
+                               (state_history_dir / "trace_history.index").string(), retain_blocks);
       if (options.at("chain-state-history").as<bool>())
          my->chain_state_log.emplace("chain_state_history", (state_history_dir / "chain_state_history.log").string(),
-                                     (state_history_dir / "chain_state_history.index").string());
+                                     (state_history_dir / "chain_state_history.index").string(), retain_blocks);
    }
    FC_LOG_AND_RETHROW()
 } // state_history_plugin::plugin_initialize
 
-void state_history_plugin::plugin_startup() { my->listen(); }
+void state_history_plugin::plugin_startup() {
+   auto& chain = my->chain_plug->chain();
+   my->set_head({chain.head_block_num(), chain.head_block_id()},
+                {chain.last_irreversible_block_num(), chain.last_irreversible_block_id()});
+   my->listen();
+}
 
 void state_history_plugin::plugin_shutdown() {
    my->applied_transaction_connection.reset();
    my->accepted_block_connection.reset();
+   my->stopping = true;
+   if (my->thread_pool)
+      my->thread_pool->stop();
+   if (my->acceptor) {
+      boost::system::error_code ec;
+      my->acceptor->close(ec);
+   }
    while (!my->sessions.empty())
       my->sessions.begin()->second->close();
-   my->stopping = true;
 }
 
 } // namespace eosio
@@ -0,0 +1,238 @@
+#define BOOST_TEST_MODULE history_filter
+#include <boost/test/included/unit_test.hpp>
+#include <eosio/state_history_plugin/history_filter.hpp>
+#include <eosio/chain/contract_table_objects.hpp>
+#include <fc/filesystem.hpp>
+
+using namespace eosio;
+using namespace eosio::chain;
+
+namespace {
+   action_trace make_action( name receiver, name account, name act_name, bool with_receipt ) {
+      action_trace a;
+      a.action_ordinal         = 1;
+      a.creator_action_ordinal = 0;
+      a.receiver               = receiver;
+      a.act.account            = account;
+      a.act.name               = act_name;
+      a.act.authorization      = { { account, config::active_name } };
+      a.act.data               = { 1, 2, 3 };
+      a.elapsed                = fc::microseconds( 17 );
+      a.console                = "console output";
+      a.account_ram_deltas.emplace( account, 42 );
+      if( with_receipt ) {
+         action_receipt r;
+         r.receiver        = receiver;
+         r.act_digest      = digest_type::hash( std::string( "act" ) );
+         r.global_sequence = 7;
+         r.recv_sequence   = 3;
+         r.auth_sequence   = { { account, 5 }, { N(other), 6 } };
+         r.code_sequence   = 1;
+         r.abi_sequence    = 2;
+         a.receipt         = r;
+      }
+      return a;
+   }
+
+   transaction_trace_ptr make_trace( const std::string& seed, std::vector<action_trace> actions ) {
+      auto t           = std::make_shared<transaction_trace>();
+      t->id            = transaction_id_type::hash( seed );
+      t->elapsed       = fc::microseconds( 100 );
+      t->net_usage     = 96;
+      t->action_traces = std::move( actions );
+      transaction_receipt_header receipt;
+      receipt.status          = transaction_receipt_header::executed;
+      receipt.cpu_usage_us    = 150;
+      receipt.net_usage_words = 12;
+      t->receipt              = receipt;
+      return t;
+   }
+
+   std::vector<augmented_transaction_trace> make_traces() {
+      std::vector<augmented_transaction_trace> traces;
+
+      // matches an account/action filter, carries a partial transaction
+      signed_transaction trx;
+      trx.expiration = fc::time_point_sec( 1000 );
+      trx.signatures.emplace_back();
+      trx.context_free_data.push_back( { 9, 9 } );
+      traces.emplace_back( make_trace( "transfer", { make_action( N(alice), N(eosio.token), N(transfer), true ),
+                                                     make_action( N(bob), N(eosio.token), N(transfer), true ) } ),
+                           trx );
+
+      // failed before it executed anything useful, matches nothing
+      auto failed = make_trace( "failed", { make_action( N(bob), N(bob), N(act), false ) } );
+      failed->action_traces[0].except     = fc::exception();
+      failed->action_traces[0].error_code = 99;
+      failed->except                      = fc::exception();
+      failed->error_code                  = 99;
+      traces.emplace_back( failed );
+
+      // only its failed deferred transaction matches
+      auto onerror = make_trace( "onerror", { make_action( N(eosio), N(eosio), N(onerror), true ) } );
+      onerror->account_ram_delta = account_delta( N(eosio), -8 );
+      onerror->failed_dtrx_trace = make_trace( "deferred", { make_action( N(carol), N(carol), N(run), false ) } );
+      onerror->failed_dtrx_trace->except = fc::exception();
+      traces.emplace_back( onerror, std::make_shared<partial_transaction>( trx ) );
+
+      return traces;
+   }
+
+   struct test_db {
+      fc::temp_directory  tempdir;
+      chainbase::database db{ tempdir.path(), chainbase::database::read_write, 8 * 1024 * 1024 };
+
+      test_db() {
+         db.add_index<table_id_multi_index>();
+         db.add_index<key_value_index>();
+      }
+
+      bytes pack_traces( const std::vector<augmented_transaction_trace>& traces, bool debug_mode ) {
+         return fc::raw::pack( make_history_context_wrapper( db, debug_mode, traces ) );
+      }
+
+      const table_id_object& add_table( name code, name scope, name table, std::vector<uint64_t> keys ) {
+         const auto& t = db.create<table_id_object>( [&]( auto& t ) {
+            t.code  = code;
+            t.scope = scope;
+            t.table = table;
+            t.payer = code;
+            t.count = keys.size();
+         } );
+         for( auto k : keys ) {
+            db.create<key_value_object>( [&]( auto& o ) {
+               o.t_id        = t.id;
+               o.primary_key = k;
+               o.payer       = code;
+               std::string value = table.to_string() + std::to_string( k );
+               o.value.assign( value.data(), value.size() );
+            } );
+         }
+         return t;
+      }
+
+      // packed like store_chain_state does for a fresh log, keeping only the contract rows of tables accepted by keep
+      template <typename F>
+      bytes pack_deltas( F&& keep ) {
+         std::vector<table_delta> deltas;
+
+         table_delta empty;
+         empty.name = "global_property";
+         deltas.push_back( empty );
+
+         table_delta other;
+         other.name = "account";
+         other.rows.obj.emplace_back( true, bytes{ 0, 1, 2, 3 } );
+         deltas.push_back( other );
+
+         table_delta tables;
+         tables.name = "contract_table";
+         for( auto& t : db.get_index<table_id_multi_index>().indices() )
+            if( keep( t ) )
+               tables.rows.obj.emplace_back( true, fc::raw::pack( make_history_serial_wrapper( db, t ) ) );
+         if( !tables.rows.obj.empty() )
+            deltas.push_back( tables );
+
+         table_delta rows;
+         rows.name = "contract_row";
+         for( auto& r : db.get_index<key_value_index>().indices() ) {
+            auto& t = db.get<table_id_object>( r.t_id );
+            if( keep( t ) )
+               rows.rows.obj.emplace_back( true, fc::raw::pack( make_history_context_wrapper( db, t, r ) ) );
+         }
+         if( !rows.rows.obj.empty() )
+            deltas.push_back( rows );
+
+         return fc::raw::pack( deltas );
+      }
+   };
+}
+
+BOOST_AUTO_TEST_CASE( filter_traces ) {
+   test_db t;
+   auto traces = make_traces();
+   for( bool debug_mode : { false, true } ) {
+      auto all = t.pack_traces( traces, debug_mode );
+
+      std::vector<action_filter> transfers{ { {}, N(eosio.token), N(transfer) } };
+      BOOST_CHECK( history_filter::filter_traces( all, transfers ) == t.pack_traces( { traces[0] }, debug_mode ) );
+
+      std::vector<action_filter> bob_transfers{ { N(bob), N(eosio.token), N(transfer) } };
+      BOOST_CHECK( history_filter::filter_traces( all, bob_transfers ) == t.pack_traces( { traces[0] }, debug_mode ) );
+
+      std::vector<action_filter> deferred{ { N(carol), {}, {} } };
+      BOOST_CHECK( history_filter::filter_traces( all, deferred ) == t.pack_traces( { traces[2] }, debug_mode ) );
+
+      std::vector<action_filter> both{ transfers[0], deferred[0] };
+      BOOST_CHECK( history_filter::filter_traces( all, both ) == t.pack_traces( { traces[0], traces[2] }, debug_mode ) );
+
+      std::vector<action_filter> anything{ {} };
+      BOOST_CHECK( history_filter::filter_traces( all, anything ) == all );
+
+      std::vector<action_filter> nothing{ { N(nobody), {}, {} } };
+      BOOST_CHECK( history_filter::filter_traces( all, nothing ) == t.pack_traces( {}, debug_mode ) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE( filter_traces_rejects_truncated_input ) {
+   test_db t;
+   auto all = t.pack_traces( make_traces(), true );
+   all.resize( all.size() / 2 );
+   std::vector<action_filter> anything{ {} };
+   BOOST_CHECK_THROW( history_filter::filter_traces( all, anything ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE( filter_deltas ) {
+   test_db t;
+   t.add_table( N(alice), N(alice), N(accounts), { 1, 2 } );
+   t.add_table( N(alice), N(bob), N(accounts), { 3 } );
+   t.add_table( N(bob), N(bob), N(data), { 4, 5, 6 } );
+   auto all = t.pack_deltas( []( auto& ) { return true; } );
+
+   std::vector<table_filter> alice{ { N(alice), {}, {} } };
+   auto kept = history_filter::filter_deltas( all, alice );
+   BOOST_CHECK( kept == t.pack_deltas( []( auto& tbl ) { return tbl.code == N(alice); } ) );
+
+   std::vector<table_filter> bob_scope{ { N(alice), N(bob), N(accounts) }, { N(bob), N(bob), N(data) } };
+   BOOST_CHECK( history_filter::filter_deltas( all, bob_scope ) ==
+                t.pack_deltas( []( auto& tbl ) { return tbl.scope == N(bob); } ) );
+
+   std::vector<table_filter> anything{ {} };
+   BOOST_CHECK( history_filter::filter_deltas( all, anything ) == all );
+
+   // contract tables left without rows are dropped, the others are kept as they were
+   std::vector<table_filter> nothing{ { N(nobody), {}, {} } };
+   BOOST_CHECK( history_filter::filter_deltas( all, nothing ) == t.pack_deltas( []( auto& ) { return false; } ) );
+
+   // the kept contract rows still unpack to the database rows they were packed from
+   fc::datastream<const char*> ds( kept.data(), kept.size() );
+   uint32_t                    num_rows = 0;
+   for( uint32_t n = history_filter::read<fc::unsigned_int>( ds ); n; --n ) {
+      history_filter::read<fc::unsigned_int>( ds );
+      auto delta_name = history_filter::read<std::string>( ds );
+      for( uint32_t i = history_filter::read<fc::unsigned_int>( ds ); i; --i ) {
+         BOOST_CHECK( history_filter::read<bool>( ds ) );
+         auto row = history_filter::read<bytes>( ds );
+         if( delta_name != "contract_row" )
+            continue;
+         fc::datastream<const char*> rds( row.data(), row.size() );
+         BOOST_CHECK_EQUAL( history_filter::read<fc::unsigned_int>( rds ).value, 0u );
+         auto code  = name( history_filter::read<uint64_t>( rds ) );
+         auto scope = name( history_filter::read<uint64_t>( rds ) );
+         auto table = name( history_filter::read<uint64_t>( rds ) );
+         auto key   = history_filter::read<uint64_t>( rds );
+         auto payer = name( history_filter::read<uint64_t>( rds ) );
+         auto value = history_filter::read<bytes>( rds );
+         BOOST_CHECK_EQUAL( rds.remaining(), 0u );
+
+         auto& tbl = t.db.get<table_id_object, by_code_scope_table>( boost::make_tuple( code, scope, table ) );
+         auto& obj = t.db.get<key_value_object, by_scope_primary>( boost::make_tuple( tbl.id, key ) );
+         BOOST_CHECK( code == N(alice) );
+         BOOST_CHECK( payer == obj.payer );
+         BOOST_CHECK( value == bytes( obj.value.data(), obj.value.data() + obj.value.size() ) );
+         ++num_rows;
+      }
+   }
+   BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+   BOOST_CHECK_EQUAL( num_rows, 3u );
+}
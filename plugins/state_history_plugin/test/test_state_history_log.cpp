@@ -0,0 +1,133 @@
+#define BOOST_TEST_MODULE state_history_log
+#include <boost/test/included/unit_test.hpp>
+#include <eosio/state_history_plugin/state_history_log.hpp>
+#include <fc/filesystem.hpp>
+
+using namespace eosio;
+
+namespace {
+   chain::block_id_type make_id( uint32_t block_num, uint64_t fork = 0 ) {
+      chain::block_id_type id;
+      id._hash[0] = fc::endian_reverse_u32( block_num );
+      id._hash[1] = fork;
+      return id;
+   }
+
+   uint64_t payload_of( uint32_t block_num, uint64_t fork ) {
+      return uint64_t(block_num) * 1000 + fork;
+   }
+
+   struct test_log {
+      fc::temp_directory tempdir;
+      fc::optional<state_history_log> log;
+
+      void open( uint32_t retain_blocks ) {
+         log.reset();
+         log.emplace( "test", (tempdir.path() / "test.log").string(), (tempdir.path() / "test.index").string(),
+                      retain_blocks );
+      }
+
+      void write( uint32_t block_num, uint64_t fork = 0, uint64_t prev_fork = 0 ) {
+         state_history_log_header header{ ship_magic( ship_current_version ), make_id( block_num, fork ), sizeof(uint64_t) };
+         uint64_t payload = payload_of( block_num, fork );
+         log->write_entry( header, make_id( block_num - 1, prev_fork ), [&]( fc::cfile& f ) {
+            f.write( (const char*)&payload, sizeof(payload) );
+         } );
+      }
+
+      // the pruned tail is swapped in by a later write, keep writing until it is
+      uint32_t write_until_pruned( uint32_t next_block ) {
+         const uint32_t begin = log->begin_block();
+         for( uint32_t i = 0; i < 1000 && log->begin_block() == begin; ++i ) {
+            write( next_block++ );
+            if( log->begin_block() == begin )
+               std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+         }
+         BOOST_REQUIRE_NE( log->begin_block(), begin );
+         return next_block;
+      }
+
+      void check( uint32_t block_num, uint64_t fork = 0 ) {
+         uint64_t payload = 0;
+         state_history_log_header header;
+         BOOST_REQUIRE( log->read_entry( block_num, [&]( fc::cfile& f, const state_history_log_header& h ) {
+            header = h;
+            f.read( (char*)&payload, sizeof(payload) );
+         } ) );
+         BOOST_CHECK( header.block_id == make_id( block_num, fork ) );
+         BOOST_CHECK_EQUAL( payload, payload_of( block_num, fork ) );
+      }
+   };
+}
+
+BOOST_AUTO_TEST_SUITE(state_history_log_tests)
+
+   BOOST_AUTO_TEST_CASE(prune_and_reopen)
+   {
+      test_log t;
+      t.open( 4 );
+      for( uint32_t block_num = 1; block_num <= 6; ++block_num )
+         t.write( block_num );
+      BOOST_REQUIRE_EQUAL( t.log->begin_block(), 1u );
+
+      // pruning started at 6 blocks keeps the 4 newest of them, blocks written while it ran are kept too
+      uint32_t next_block = t.write_until_pruned( 7 );
+      BOOST_REQUIRE_EQUAL( t.log->begin_block(), 3u );
+      BOOST_REQUIRE_EQUAL( t.log->end_block(), next_block );
+      BOOST_CHECK( !t.log->read_entry( 2, []( fc::cfile&, const state_history_log_header& ) {} ) );
+      for( uint32_t block_num = 3; block_num < next_block; ++block_num )
+         t.check( block_num );
+
+      t.open( 4 );
+      BOOST_REQUIRE_EQUAL( t.log->begin_block(), 3u );
+      BOOST_REQUIRE_EQUAL( t.log->end_block(), next_block );
+      for( uint32_t block_num = 3; block_num < next_block; ++block_num )
+         t.check( block_num );
+
+      // entries written after reopening land at the right positions
+      t.write( next_block++ );
+      t.check( next_block - 1 );
+   }
+
+   BOOST_AUTO_TEST_CASE(prune_on_open)
+   {
+      test_log t;
+      t.open( 0 );
+      for( uint32_t block_num = 1; block_num <= 20; ++block_num )
+         t.write( block_num );
+
+      // lowering the limit prunes an existing log, the first write after the copy swaps it in
+      t.open( 4 );
+      BOOST_REQUIRE_EQUAL( t.log->begin_block(), 1u );
+      uint32_t next_block = t.write_until_pruned( 21 );
+      BOOST_REQUIRE_EQUAL( t.log->begin_block(), 17u );
+      for( uint32_t block_num = 17; block_num < next_block; ++block_num )
+         t.check( block_num );
+
+      t.open( 4 );
+      BOOST_REQUIRE_EQUAL( t.log->begin_block(), 17u );
+      BOOST_REQUIRE_EQUAL( t.log->end_block(), next_block );
+   }
+
+   BOOST_AUTO_TEST_CASE(fork_during_prune)
+   {
+      test_log t;
+      t.open( 4 );
+      for( uint32_t block_num = 1; block_num <= 6; ++block_num )
+         t.write( block_num );
+
+      // replacing a block the prune is copying throws the copy away
+      t.write( 5, 1 );
+      t.write( 6, 1, 1 );
+      BOOST_REQUIRE_EQUAL( t.log->begin_block(), 1u );
+      BOOST_REQUIRE_EQUAL( t.log->end_block(), 7u );
+      t.check( 4 );
+      t.check( 5, 1 );
+      t.check( 6, 1 );
+
+      t.open( 4 );
+      BOOST_REQUIRE_EQUAL( t.log->begin_block(), 1u );
+      t.check( 6, 1 );
+   }
+
+BOOST_AUTO_TEST_SUITE_END()
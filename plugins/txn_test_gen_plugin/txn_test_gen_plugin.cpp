@@ -12,6 +12,9 @@
 #include <boost/asio/high_resolution_timer.hpp>
 #include <boost/algorithm/clamp.hpp>
 
+#include <atomic>
+#include <mutex>
+
 #include <Inline/BasicTypes.h>
 #include <IR/Module.h>
 #include <IR/Validate.h>
@@ -28,10 +31,28 @@ namespace eosio { namespace detail {
   struct txn_test_gen_status {
      string status;
   };
+  struct txn_test_gen_load_status {
+     string                status;
+     uint64_t              target_tps = 0;
+     uint64_t              pool_size = 0;
+     uint64_t              signed_trxs = 0;
+     uint64_t              sent = 0;
+     uint64_t              succeeded = 0;
+     uint64_t              failed = 0;
+     double                elapsed_sec = 0;
+     double                achieved_tps = 0;
+     uint64_t              latency_p50_us = 0;
+     uint64_t              latency_p90_us = 0;
+     uint64_t              latency_p99_us = 0;
+     uint64_t              latency_max_us = 0;
+     std::map<string, uint64_t> failure_reasons;
+  };
 }}
 
 FC_REFLECT(eosio::detail::txn_test_gen_empty, );
 FC_REFLECT(eosio::detail::txn_test_gen_status, (status));
+FC_REFLECT(eosio::detail::txn_test_gen_load_status, (status)(target_tps)(pool_size)(signed_trxs)(sent)(succeeded)(failed)(elapsed_sec)(achieved_tps)
+                                                    (latency_p50_us)(latency_p90_us)(latency_p99_us)(latency_max_us)(failure_reasons));
 
 namespace eosio {
 
@@ -65,6 +86,9 @@ using namespace eosio::chain;
      api_handle->call_name(); \
      eosio::detail::txn_test_gen_empty result;
 
+#define INVOKE_R_V(api_handle, call_name) \
+     auto result = api_handle->call_name();
+
 #define CALL_ASYNC(api_name, api_handle, call_name, INVOKE, http_response_code) \
 {std::string("/v1/" #api_name "/" #call_name), \
    [this](string, string body, url_response_callback cb) mutable { \
@@ -93,6 +117,22 @@ using namespace eosio::chain;
 
 struct txn_test_gen_plugin_impl {
 
+   /// state of a start_load run; shared with the thread pool and the transaction callbacks
+   struct load_state {
+      uint64_t                               target_tps = 0;
+      std::vector<packed_transaction_ptr>    pool;
+      std::atomic<uint64_t>                  signed_trxs{0};
+      size_t                                 next_to_send = 0;        // only touched on the main thread
+      std::vector<fc::time_point>            submit_times;            // only touched on the main thread
+      std::mutex                             mtx;                     // guards start and the results below
+      fc::time_point                         start;                   // set once signing completes
+      uint64_t                               succeeded = 0;
+      uint64_t                               failed = 0;
+      fc::time_point                         last_completion;
+      std::vector<uint32_t>                  latencies_us;
+      std::map<string, uint64_t>             failure_reasons;
+   };
+
    uint64_t _total_us = 0;
    uint64_t _txcount = 0;
 
@@ -385,6 +425,180 @@ struct txn_test_gen_plugin_impl {
       push_transactions(std::move(trxs), next);
    }
 
+   string start_load(const std::string& salt, const uint64_t& target_tps, const uint64_t& pool_size) {
+      ilog("Starting transaction test plugin load mode");
+      if(running)
+         return "start_generation already running";
+      if(target_tps < 1 || target_tps > 1000000)
+         return "target_tps must be between 1 and 1000000";
+      if(pool_size < 2 || pool_size > 10000000)
+         return "pool_size must be between 2 and 10000000";
+
+      running = true;
+
+      controller& cc = app().get_plugin<chain_plugin>().chain();
+      auto abi_serializer_max_time = app().get_plugin<chain_plugin>().get_abi_serializer_max_time();
+      abi_serializer eosio_token_serializer{fc::json::from_string(contracts::eosio_token_abi().data()).as<abi_def>(), abi_serializer::create_yield_function( abi_serializer_max_time )};
+      auto make_transfer = [&](name from, name to) {
+         action act;
+         act.account = newaccountT;
+         act.name = N(transfer);
+         act.authorization = vector<permission_level>{{from,config::active_name}};
+         act.data = eosio_token_serializer.variant_to_binary("transfer",
+                                                             fc::json::from_string(fc::format_string("{\"from\":\"${from}\",\"to\":\"${to}\",\"quantity\":\"0.0001 CUR\",\"memo\":\"${l}\"}",
+                                                             fc::mutable_variant_object()("from",from.to_string())("to",to.to_string())("l", salt))),
+                                                             abi_serializer::create_yield_function( abi_serializer_max_time ));
+         return act;
+      };
+      const action a_to_b = make_transfer(newaccountA, newaccountB);
+      const action b_to_a = make_transfer(newaccountB, newaccountA);
+
+      // the whole pool must stay valid until it has been injected, within the maximum transaction lifetime
+      const uint32_t max_lifetime = cc.get_global_properties().configuration.max_transaction_lifetime;
+      const uint64_t expected_run_sec = pool_size / target_tps + 1;
+      const fc::time_point_sec expiration = cc.head_block_time() + fc::seconds(std::min<uint64_t>(expected_run_sec + 60, max_lifetime - 10));
+      const block_id_type reference_block_id = cc.head_block_id();
+      const chain_id_type chainid = app().get_plugin<chain_plugin>().get_chain_id();
+      const uint64_t nonce_base = static_cast<uint64_t>(fc::time_point::now().sec_since_epoch()) << 32;
+
+      load = std::make_shared<load_state>();
+      load->target_tps = target_tps;
+      load->pool.resize(pool_size);
+
+      thread_pool.emplace( "txntest", thread_pool_size );
+      timer = std::make_shared<boost::asio::high_resolution_timer>(thread_pool->get_executor());
+
+      ilog("Pre-signing ${p} transactions on ${t} load generation threads, to be injected at ${r} TPS",
+           ("p", pool_size)("t", thread_pool_size)("r", target_tps));
+
+      // sign the pool in chunks across every thread; the last chunk to finish kicks off injection
+      const size_t chunk_size = 1000;
+      const size_t num_chunks = (pool_size + chunk_size - 1) / chunk_size;
+      auto chunks_remaining = std::make_shared<std::atomic<size_t>>(num_chunks);
+      for(size_t chunk = 0; chunk < num_chunks; ++chunk) {
+         boost::asio::post( thread_pool->get_executor(), [this, ld = load, chunk, chunk_size, chunks_remaining, a_to_b, b_to_a,
+                                                          expiration, reference_block_id, chainid, nonce_base, salt]() {
+            static const fc::crypto::private_key a_priv_key = fc::crypto::private_key::regenerate(fc::sha256(std::string(64, 'a')));
+            static const fc::crypto::private_key b_priv_key = fc::crypto::private_key::regenerate(fc::sha256(std::string(64, 'b')));
+
+            const size_t end = std::min(ld->pool.size(), (chunk + 1) * chunk_size);
+            for(size_t i = chunk * chunk_size; i < end && running; ++i) {
+               const bool from_a = (i & 1) == 0;
+               signed_transaction trx;
+               trx.actions.push_back(from_a ? a_to_b : b_to_a);
+               trx.context_free_actions.emplace_back(action({}, config::null_account_name, name("nonce"), fc::raw::pack( salt + std::to_string(nonce_base + i) )));
+               trx.set_reference_block(reference_block_id);
+               trx.expiration = expiration;
+               trx.max_net_usage_words = 100;
+               trx.sign(from_a ? a_priv_key : b_priv_key, chainid);
+               ld->pool[i] = std::make_shared<packed_transaction>(std::move(trx));
+               ++ld->signed_trxs;
+            }
+
+            if(--(*chunks_remaining) == 0 && running) {
+               ilog("Pre-signed ${p} transactions; starting injection", ("p", ld->pool.size()));
+               {
+                  std::lock_guard<std::mutex> g(ld->mtx);
+                  ld->start = fc::time_point::now();
+               }
+               arm_load_timer(boost::asio::high_resolution_timer::clock_type::now());
+            }
+         });
+      }
+
+      return "success";
+   }
+
+   /// every millisecond hand the main thread however many transactions are due to meet the target rate
+   void arm_load_timer(boost::asio::high_resolution_timer::time_point s) {
+      timer->expires_at(s + std::chrono::milliseconds(1));
+      timer->async_wait([this, ld = load](const boost::system::error_code& ec) {
+         if(!running || ec)
+            return;
+         fc::time_point start;
+         {
+            std::lock_guard<std::mutex> g(ld->mtx);
+            start = ld->start;
+         }
+         const uint64_t elapsed_us = (fc::time_point::now() - start).count();
+         const uint64_t due = std::min<uint64_t>(ld->pool.size(), ld->target_tps * elapsed_us / 1000000 + 1);
+         app().post(priority::low, [this, ld, due]() {
+            inject_due_transactions(ld, due);
+         });
+         if(due < ld->pool.size())
+            arm_load_timer(timer->expires_at());
+      });
+   }
+
+   void inject_due_transactions(const std::shared_ptr<load_state>& ld, size_t due) {
+      if(!running || ld != load)
+         return;
+      chain_plugin& cp = app().get_plugin<chain_plugin>();
+      ld->submit_times.resize(ld->pool.size());
+
+      for(; ld->next_to_send < due; ++ld->next_to_send) {
+         const size_t i = ld->next_to_send;
+         ld->submit_times[i] = fc::time_point::now();
+         cp.accept_transaction( ld->pool[i], [ld, i](const fc::static_variant<fc::exception_ptr, transaction_trace_ptr>& result) {
+            const fc::time_point now = fc::time_point::now();
+            std::lock_guard<std::mutex> g(ld->mtx);
+            ld->last_completion = now;
+            ld->latencies_us.push_back( static_cast<uint32_t>((now - ld->submit_times[i]).count()) );
+            if(result.contains<fc::exception_ptr>()) {
+               ++ld->failed;
+               ++ld->failure_reasons[result.get<fc::exception_ptr>()->name()];
+            } else if(result.get<transaction_trace_ptr>()->except) {
+               ++ld->failed;
+               ++ld->failure_reasons[result.get<transaction_trace_ptr>()->except->name()];
+            } else {
+               ++ld->succeeded;
+            }
+         });
+         ld->pool[i].reset();
+      }
+   }
+
+   detail::txn_test_gen_load_status load_status() {
+      detail::txn_test_gen_load_status st;
+      if(!load) {
+         st.status = "no load run";
+         return st;
+      }
+      const std::shared_ptr<load_state> ld = load;
+      st.target_tps = ld->target_tps;
+      st.pool_size = ld->pool.size();
+      st.signed_trxs = ld->signed_trxs;
+      st.sent = ld->next_to_send;
+
+      std::lock_guard<std::mutex> g(ld->mtx);
+      st.succeeded = ld->succeeded;
+      st.failed = ld->failed;
+      st.failure_reasons = ld->failure_reasons;
+      if(st.succeeded + st.failed == st.pool_size)
+         st.status = "complete";
+      else if(!running)
+         st.status = "stopped";
+      else if(ld->start == fc::time_point())
+         st.status = "signing";
+      else
+         st.status = "injecting";
+
+      if(ld->start != fc::time_point() && ld->last_completion > ld->start) {
+         st.elapsed_sec = (ld->last_completion - ld->start).count() / 1000000.0;
+         st.achieved_tps = st.succeeded / st.elapsed_sec;
+      }
+      if(ld->latencies_us.size()) {
+         std::vector<uint32_t> lat = ld->latencies_us;
+         std::sort(lat.begin(), lat.end());
+         auto percentile = [&lat](double p) { return lat[std::min(lat.size() - 1, static_cast<size_t>(p * lat.size()))]; };
+         st.latency_p50_us = percentile(0.50);
+         st.latency_p90_us = percentile(0.90);
+         st.latency_p99_us = percentile(0.99);
+         st.latency_max_us = lat.back();
+      }
+      return st;
+   }
+
    void stop_generation() {
       if(!running)
          throw fc::exception(fc::invalid_operation_exception_code);
@@ -395,6 +609,13 @@ struct txn_test_gen_plugin_impl {
 
       ilog("Stopping transaction generation test");
 
+      if (load) {
+         const auto st = load_status();
+         ilog("load run: ${s} of ${p} sent, ${ok} succeeded, ${f} failed, ${tps} TPS achieved, latency p50 ${p50}us p99 ${p99}us",
+              ("s", st.sent)("p", st.pool_size)("ok", st.succeeded)("f", st.failed)("tps", st.achieved_tps)
+              ("p50", st.latency_p50_us)("p99", st.latency_p99_us));
+      }
+
       if (_txcount) {
          ilog("${d} transactions executed, ${t}us / transaction", ("d", _txcount)("t", _total_us / (double)_txcount));
          _txcount = _total_us = 0;
@@ -411,6 +632,8 @@ struct txn_test_gen_plugin_impl {
    action act_b_to_a;
 
    int32_t txn_reference_block_lag;
+
+   std::shared_ptr<load_state> load;
 };
 
 txn_test_gen_plugin::txn_test_gen_plugin() {}
@@ -442,7 +665,9 @@ void txn_test_gen_plugin::plugin_startup() {
    app().get_plugin<http_plugin>().add_api({
       CALL_ASYNC(txn_test_gen, my, create_test_accounts, INVOKE_ASYNC_R_R(my, create_test_accounts, std::string, std::string), 200),
       CALL(txn_test_gen, my, stop_generation, INVOKE_V_V(my, stop_generation), 200),
-      CALL(txn_test_gen, my, start_generation, INVOKE_V_R_R_R(my, start_generation, std::string, uint64_t, uint64_t), 200)
+      CALL(txn_test_gen, my, start_generation, INVOKE_V_R_R_R(my, start_generation, std::string, uint64_t, uint64_t), 200),
+      CALL(txn_test_gen, my, start_load, INVOKE_V_R_R_R(my, start_load, std::string, uint64_t, uint64_t), 200),
+      CALL(txn_test_gen, my, load_status, INVOKE_R_V(my, load_status), 200)
    });
 }
 
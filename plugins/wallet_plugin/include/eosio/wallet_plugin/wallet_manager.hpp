@@ -1,5 +1,6 @@
 #pragma once
 #include <eosio/chain/transaction.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <eosio/wallet_plugin/wallet_api.hpp>
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/filesystem/path.hpp>
@@ -39,6 +40,9 @@ public:
    /// @see wallet_manager::set_timeout(const std::chrono::seconds& t)
    /// @param secs The timeout in seconds.
    void set_timeout(int64_t secs) { set_timeout(std::chrono::seconds(secs)); }
+
+   /// Set the number of threads used by sign_transactions. With 0 threads, batches are signed on the calling thread.
+   void set_signing_threads(uint16_t num_threads);
       
    /// Sign transaction with the private keys specified via their public keys.
    /// Use chain_controller::get_required_keys to determine which keys are needed for txn.
@@ -51,6 +55,18 @@ public:
                                              const chain::chain_id_type& id);
 
 
+   /// Sign many transactions with the same set of private keys specified via their public keys.
+   /// Keys are looked up once for the whole batch, and transactions are signed concurrently on the signing thread pool
+   /// (see set_signing_threads) when the keys are held in soft wallets.
+   /// @param txns the transactions to sign.
+   /// @param keys the public keys of the corresponding private keys to sign every transaction with
+   /// @param id the chain_id to sign transactions with.
+   /// @return txns signed, in the same order
+   /// @throws fc::exception if corresponding private keys not found in unlocked wallets
+   std::vector<chain::signed_transaction> sign_transactions(const std::vector<chain::signed_transaction>& txns,
+                                                            const flat_set<public_key_type>& keys,
+                                                            const chain::chain_id_type& id);
+
    /// Sign digest with the private keys specified via their public keys.
    /// @param digest the digest to sign.
    /// @param key the public key of the corresponding private key to sign the digest with
@@ -130,6 +146,9 @@ private:
    /// Calls lock_all() if timeout has passed.
    void check_timeout();
 
+   /// @return the unlocked wallet holding the private key for key, or nullptr if there is none
+   wallet_api* find_signing_wallet(const public_key_type& key);
+
 private:
    using timepoint_t = std::chrono::time_point<std::chrono::system_clock>;
    std::map<std::string, std::unique_ptr<wallet_api>> wallets;
@@ -139,6 +158,12 @@ private:
    boost::filesystem::path lock_path = dir / "wallet.lock";
    std::unique_ptr<boost::interprocess::file_lock> wallet_dir_lock;
 
+   /// public key -> unlocked wallet holding it; rebuilt on first use after any wallet is opened, locked, unlocked or has its keys changed
+   std::map<public_key_type, wallet_api*> key_index;
+   bool key_index_stale = true;
+
+   fc::optional<eosio::chain::named_thread_pool> signing_thread_pool;
+
    void start_lock_watch(std::shared_ptr<boost::asio::deadline_timer> t);
    void initialize_lock();
 };
@@ -4,6 +4,10 @@
 #include <eosio/wallet_plugin/se_wallet.hpp>
 #include <eosio/chain/exceptions.hpp>
 #include <boost/algorithm/string.hpp>
+
+#include <future>
+#include <thread>
+
 namespace eosio {
 namespace wallet {
 
@@ -84,6 +88,7 @@ std::string wallet_manager::create(const std::string& name) {
       wallets.erase(it);
    }
    wallets.emplace(name, std::move(wallet));
+   key_index_stale = true;
 
    return password;
 }
@@ -108,6 +113,7 @@ void wallet_manager::open(const std::string& name) {
       wallets.erase(it);
    }
    wallets.emplace(name, std::move(wallet));
+   key_index_stale = true;
 }
 
 std::vector<std::string> wallet_manager::list_wallets() {
@@ -153,6 +159,7 @@ flat_set<public_key_type> wallet_manager::get_public_keys() {
 
 void wallet_manager::lock_all() {
    // no call to check_timeout since we are locking all anyway
+   key_index_stale = true;
    for (auto& i : wallets) {
       if (!i.second->is_locked()) {
          i.second->lock();
@@ -170,6 +177,7 @@ void wallet_manager::lock(const std::string& name) {
       return;
    }
    w->lock();
+   key_index_stale = true;
 }
 
 void wallet_manager::unlock(const std::string& name, const std::string& password) {
@@ -183,6 +191,7 @@ void wallet_manager::unlock(const std::string& name, const std::string& password
       return;
    }
    w->unlock(password);
+   key_index_stale = true;
 }
 
 void wallet_manager::import_key(const std::string& name, const std::string& wif_key) {
@@ -195,6 +204,7 @@ void wallet_manager::import_key(const std::string& name, const std::string& wif_
       EOS_THROW(chain::wallet_locked_exception, "Wallet is locked: ${w}", ("w", name));
    }
    w->import_key(wif_key);
+   key_index_stale = true;
 }
 
 void wallet_manager::remove_key(const std::string& name, const std::string& password, const std::string& key) {
@@ -208,6 +218,7 @@ void wallet_manager::remove_key(const std::string& name, const std::string& pass
    }
    w->check_password(password); //throws if bad password
    w->remove_key(key);
+   key_index_stale = true;
 }
 
 string wallet_manager::create_key(const std::string& name, const std::string& key_type) {
@@ -221,45 +232,130 @@ string wallet_manager::create_key(const std::string& name, const std::string& ke
    }
 
    string upper_key_type = boost::to_upper_copy<std::string>(key_type);
+   key_index_stale = true;
    return w->create_key(upper_key_type);
 }
 
+wallet_api* wallet_manager::find_signing_wallet(const public_key_type& key) {
+   if (key_index_stale) {
+      key_index.clear();
+      // wallets is ordered by name, so when several wallets hold a key the first one by name is used
+      for (const auto& i : wallets) {
+         if (!i.second->is_locked()) {
+            for (const auto& pk : i.second->list_public_keys())
+               key_index.emplace(pk, i.second.get());
+         }
+      }
+      key_index_stale = false;
+   }
+
+   auto it = key_index.find(key);
+   return it == key_index.end() ? nullptr : it->second;
+}
+
+void wallet_manager::set_signing_threads(uint16_t num_threads) {
+   signing_thread_pool.reset();
+   if (num_threads > 0)
+      signing_thread_pool.emplace("wallet", num_threads);
+}
+
 chain::signed_transaction
 wallet_manager::sign_transaction(const chain::signed_transaction& txn, const flat_set<public_key_type>& keys, const chain::chain_id_type& id) {
    check_timeout();
    chain::signed_transaction stxn(txn);
+   const chain::digest_type digest = stxn.sig_digest(id, stxn.context_free_data);
 
    for (const auto& pk : keys) {
-      bool found = false;
-      for (const auto& i : wallets) {
-         if (!i.second->is_locked()) {
-            fc::optional<signature_type> sig = i.second->try_sign_digest(stxn.sig_digest(id, stxn.context_free_data), pk);
-            if (sig) {
-               stxn.signatures.push_back(*sig);
-               found = true;
-               break; // inner for
-            }
-         }
-      }
-      if (!found) {
+      wallet_api* w = find_signing_wallet(pk);
+      fc::optional<signature_type> sig;
+      if (w)
+         sig = w->try_sign_digest(digest, pk);
+      if (!sig) {
          EOS_THROW(chain::wallet_missing_pub_key_exception, "Public key not found in unlocked wallets ${k}", ("k", pk));
       }
+      stxn.signatures.push_back(*sig);
    }
 
    return stxn;
 }
 
+std::vector<chain::signed_transaction>
+wallet_manager::sign_transactions(const std::vector<chain::signed_transaction>& txns, const flat_set<public_key_type>& keys,
+                                  const chain::chain_id_type& id) {
+   check_timeout();
+
+   // resolve every key once for the whole batch. Soft wallet keys are already decrypted in memory and signing with a
+   // copy of them is thread safe; any other wallet type is only ever asked to sign from this thread
+   std::vector<wallet_api*> signers;
+   std::vector<fc::optional<private_key_type>> soft_keys;
+   for (const auto& pk : keys) {
+      wallet_api* w = find_signing_wallet(pk);
+      if (!w) {
+         EOS_THROW(chain::wallet_missing_pub_key_exception, "Public key not found in unlocked wallets ${k}", ("k", pk));
+      }
+      signers.push_back(w);
+      soft_keys.emplace_back();
+      if (dynamic_cast<soft_wallet*>(w))
+         soft_keys.back() = w->get_private_key(pk);
+   }
+
+   std::vector<chain::signed_transaction> result(txns);
+   std::vector<chain::digest_type> digests(result.size());
+   std::vector<std::vector<fc::optional<signature_type>>> sigs(result.size());
+
+   auto sign_range = [&](size_t begin, size_t end) {
+      for (size_t t = begin; t < end; ++t) {
+         digests[t] = result[t].sig_digest(id, result[t].context_free_data);
+         sigs[t].resize(soft_keys.size());
+         for (size_t k = 0; k < soft_keys.size(); ++k) {
+            if (soft_keys[k])
+               sigs[t][k] = soft_keys[k]->sign(digests[t]);
+         }
+      }
+   };
+
+   if (signing_thread_pool && result.size() > 1) {
+      const size_t num_chunks = std::min<size_t>(result.size(), 4u * std::thread::hardware_concurrency() + 1u);
+      const size_t chunk_size = (result.size() + num_chunks - 1) / num_chunks;
+      std::vector<std::future<void>> futures;
+      for (size_t begin = 0; begin < result.size(); begin += chunk_size) {
+         const size_t end = std::min(result.size(), begin + chunk_size);
+         futures.emplace_back(eosio::chain::async_thread_pool(signing_thread_pool->get_executor(), [&sign_range, begin, end]() {
+            sign_range(begin, end);
+         }));
+      }
+      for (auto& f : futures)
+         f.get();
+   } else {
+      sign_range(0, result.size());
+   }
+
+   size_t k = 0;
+   for (const auto& pk : keys) {
+      for (size_t t = 0; t < result.size(); ++t) {
+         if (!sigs[t][k])
+            sigs[t][k] = signers[k]->try_sign_digest(digests[t], pk);
+         if (!sigs[t][k]) {
+            EOS_THROW(chain::wallet_missing_pub_key_exception, "Public key not found in unlocked wallets ${k}", ("k", pk));
+         }
+         result[t].signatures.push_back(*sigs[t][k]);
+      }
+      ++k;
+   }
+
+   return result;
+}
+
 chain::signature_type
 wallet_manager::sign_digest(const chain::digest_type& digest, const public_key_type& key) {
    check_timeout();
 
    try {
-      for (const auto& i : wallets) {
-         if (!i.second->is_locked()) {
-            fc::optional<signature_type> sig = i.second->try_sign_digest(digest, key);
-            if (sig)
-               return *sig;
-         }
+      wallet_api* w = find_signing_wallet(key);
+      if (w) {
+         fc::optional<signature_type> sig = w->try_sign_digest(digest, key);
+         if (sig)
+            return *sig;
       }
    } FC_LOG_AND_RETHROW();
 
@@ -270,6 +366,7 @@ void wallet_manager::own_and_use_wallet(const string& name, std::unique_ptr<wall
    if(wallets.find(name) != wallets.end())
       EOS_THROW(wallet_exception, "Tried to use wallet name that already exists.");
    wallets.emplace(name, std::move(wallet));
+   key_index_stale = true;
 }
 
 void wallet_manager::start_lock_watch(std::shared_ptr<boost::asio::deadline_timer> t)
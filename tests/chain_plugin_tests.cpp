@@ -118,4 +118,74 @@ BOOST_FIXTURE_TEST_CASE( get_block_with_invalid_abi, TESTER ) try {
 
 } FC_LOG_AND_RETHROW() /// get_block_with_invalid_abi
 
+// fails every action except pass
+static const char pass_or_fail_wast[] = R"=====(
+(module
+ (import "env" "eosio_assert" (func $eosio_assert (param i32 i32)))
+ (memory $0 1)
+ (export "apply" (func $apply))
+ (func $apply (param $0 i64)(param $1 i64)(param $2 i64)
+   (call $eosio_assert (i64.eq (get_local $2) (i64.const -6219048872933588992)) (i32.const 0))
+ )
+)
+)=====";
+
+BOOST_FIXTURE_TEST_CASE( push_packed_transactions_results_in_order, TESTER ) try {
+   produce_blocks(2);
+   create_accounts( {N(passfail)} );
+   set_code( N(passfail), pass_or_fail_wast );
+   produce_block();
+
+   // stands in for the producer plugin, completing transactions in reverse order once all are submitted
+   std::vector<std::function<void()>> completions;
+   auto provider = appbase::app().get_method<chain::plugin_interface::incoming::methods::transaction_async>().register_provider(
+         [&]( const packed_transaction_ptr& trx, bool, chain::plugin_interface::next_function<transaction_trace_ptr> next ) {
+      auto copy = *trx;
+      completions.emplace_back( [this, copy, next]() mutable {
+         try {
+            next( push_transaction( copy ) );
+         } catch( const fc::exception& e ) {
+            next( e.dynamic_copy_exception() );
+         }
+      } );
+   } );
+
+   std::vector<packed_transaction> trxs;
+   std::vector<transaction_id_type> ids;
+   for( auto act : { N(pass), N(fail), N(pass) } ) {
+      signed_transaction trx;
+      trx.actions.emplace_back( vector<permission_level>{{N(passfail), config::active_name}}, N(passfail), act,
+                                fc::raw::pack( trxs.size() ) );
+      set_transaction_headers( trx );
+      trx.sign( get_private_key( N(passfail), "active" ), control->get_chain_id() );
+      ids.push_back( trx.id() );
+      trxs.emplace_back( trx, packed_transaction::compression_type::none );
+   }
+
+   // the endpoint takes the raw packed vector as its body
+   const auto body = fc::raw::pack( trxs );
+   auto params = fc::raw::unpack<chain_apis::read_write::push_packed_transactions_params>( body );
+
+   chain_apis::read_write rw( *control, fc::microseconds::maximum(), true );
+   fc::optional<chain_apis::read_write::push_packed_transactions_results> results;
+   rw.push_packed_transactions( std::move( params ),
+         [&]( const fc::static_variant<fc::exception_ptr, chain_apis::read_write::push_packed_transactions_results>& r ) {
+      BOOST_REQUIRE( r.contains<chain_apis::read_write::push_packed_transactions_results>() );
+      results = r.get<chain_apis::read_write::push_packed_transactions_results>();
+   } );
+   BOOST_REQUIRE_EQUAL( completions.size(), 3u );
+   BOOST_REQUIRE( !results );
+   for( auto itr = completions.rbegin(); itr != completions.rend(); ++itr )
+      (*itr)();
+
+   BOOST_REQUIRE( results );
+   BOOST_REQUIRE_EQUAL( results->size(), 3u );
+   for( size_t i = 0; i < 3; ++i )
+      BOOST_CHECK_EQUAL( results->at( i ).transaction_id, ids[i] );
+   BOOST_CHECK( !results->at( 0 ).processed.get_object().contains( "error" ) );
+   BOOST_CHECK( results->at( 1 ).processed.get_object().contains( "error" ) );
+   BOOST_CHECK( !results->at( 2 ).processed.get_object().contains( "error" ) );
+   BOOST_CHECK( results->at( 2 ).processed["id"].as<transaction_id_type>() == ids[2] );
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
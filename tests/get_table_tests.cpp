@@ -239,6 +239,11 @@ BOOST_FIXTURE_TEST_CASE( get_table_test, TESTER ) try {
       BOOST_REQUIRE_EQUAL("eosio", result.rows[2]["payer"].as_string());
       BOOST_REQUIRE_EQUAL("eosio", result.rows[3]["payer"].as_string());
    }
+   // rows written straight to json match the variant result
+   BOOST_REQUIRE_EQUAL(fc::json::to_string(fc::variant(result), fc::time_point::maximum()), plugin.read_only::get_table_rows_json(p));
+   p.json = false;
+   BOOST_REQUIRE_EQUAL(fc::json::to_string(fc::variant(plugin.read_only::get_table_rows(p)), fc::time_point::maximum()), plugin.read_only::get_table_rows_json(p));
+   p.json = true;
    p.show_payer = false;
 
    // get table: normal case, with bound
@@ -432,6 +437,7 @@ BOOST_FIXTURE_TEST_CASE( get_table_by_seckey_test, TESTER ) try {
       BOOST_REQUIRE_EQUAL("initd", result.rows[0]["high_bidder"].as_string());
       BOOST_REQUIRE_EQUAL("140000", result.rows[0]["high_bid"].as_string());
    }
+   BOOST_REQUIRE_EQUAL(fc::json::to_string(fc::variant(result), fc::time_point::maximum()), plugin.read_only::get_table_rows_json(p));
 
    // limit to 1 reverse, (get the lowest bidname)
    p.reverse = true;
@@ -5,6 +5,7 @@ from Cluster import Cluster, PFSetupPolicy
 from WalletMgr import WalletMgr
 from Node import Node
 from Node import ReturnType
+from TestHelper import AppArgs
 from TestHelper import TestHelper
 
 import decimal
@@ -15,6 +16,7 @@ import time
 # prod_preactivation_test
 # --dump-error-details <Upon error print etc/eosio/node_*/config.ini and var/lib/node_*/stderr.log to stdout>
 # --keep-logs <Don't delete var/lib/node_* folders upon test completion>
+# --pre-assemble-blocks 1 <Run the producers with --pre-assemble-blocks>
 ###############################################################
 
 Print=Utils.Print
@@ -22,9 +24,11 @@ errorExit=Utils.errorExit
 cmdError=Utils.cmdError
 from core_symbol import CORE_SYMBOL
 
+appArgs=AppArgs()
+appArgs.add(flag="--pre-assemble-blocks", type=int, help="Run the producers with --pre-assemble-blocks when 1", default=0, choices=[0,1])
 args = TestHelper.parse_args({"--host","--port","--defproducera_prvt_key","--defproducerb_prvt_key","--mongodb"
                               ,"--dump-error-details","--dont-launch","--keep-logs","-v","--leave-running","--only-bios","--clean-run"
-                              ,"--sanity-test","--wallet-port"})
+                              ,"--sanity-test","--wallet-port"}, applicationSpecificArgs=appArgs)
 server=args.host
 port=args.port
 debug=args.v
@@ -40,6 +44,7 @@ onlyBios=args.only_bios
 killAll=args.clean_run
 sanityTest=args.sanity_test
 walletPort=args.wallet_port
+preAssembleBlocks=args.pre_assemble_blocks == 1
 
 Utils.Debug=debug
 localTest=True
@@ -68,7 +73,8 @@ try:
         Print("Stand up cluster")
         if cluster.launch(pnodes=prodCount, totalNodes=prodCount, prodCount=1, onlyBios=onlyBios,
                          dontBootstrap=dontBootstrap, useBiosBootFile=False,
-                         pfSetupPolicy=PFSetupPolicy.NONE, extraNodeosArgs=" --plugin eosio::producer_api_plugin  --http-max-response-time-ms 990000 ") is False:
+                         pfSetupPolicy=PFSetupPolicy.NONE, extraNodeosArgs=" --plugin eosio::producer_api_plugin  --http-max-response-time-ms 990000 "
+                                                                           + (" --pre-assemble-blocks " if preAssembleBlocks else "")) is False:
             cmdError("launcher")
             errorExit("Failed to stand up eos cluster.")
 
@@ -173,6 +179,13 @@ try:
     retMap = node0.publishContract("eosio", contractDir, wasmFile, abiFile, True)
     Print("sucessfully set new contract with new intrinsic!!!")
 
+    if preAssembleBlocks:
+        # with no features left to signal the producers pre-assemble again; blocks must keep coming
+        headBlockNum = node0.getHeadBlockNum()
+        Print("Wait for block %d with blocks pre-assembled" % (headBlockNum + 24))
+        if not node0.waitForBlock(headBlockNum + 24, timeout=30):
+            errorExit("Producers with --pre-assemble-blocks stopped producing")
+
     testSuccessful=True
 finally:
     TestHelper.shutdown(cluster, walletMgr, testSuccessful, killEosInstances, killWallet, keepLogs, killAll, dumpErrorDetails)
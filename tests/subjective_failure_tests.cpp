@@ -0,0 +1,106 @@
+#include <boost/test/unit_test.hpp>
+
+#include <eosio/testing/tester.hpp>
+#include <eosio/chain/exceptions.hpp>
+#include <eosio/producer_plugin/subjective_failure_tracker.hpp>
+
+#include <contracts.hpp>
+
+using namespace eosio;
+using namespace eosio::chain;
+using namespace eosio::testing;
+
+namespace {
+   // fails every action except pass
+   const char failer_wast[] = R"=====(
+(module
+ (import "env" "eosio_assert" (func $eosio_assert (param i32 i32)))
+ (memory $0 1)
+ (export "apply" (func $apply))
+ (func $apply (param $0 i64)(param $1 i64)(param $2 i64)
+   (call $eosio_assert (i64.eq (get_local $2) (i64.const -6219048872933588992)) (i32.const 0))
+ )
+)
+)=====";
+
+   // what producer_plugin does with a failed trace
+   void charge( subjective_failure_tracker& tracker, const transaction_trace_ptr& trace, const fc::time_point& now ) {
+      BOOST_REQUIRE( trace->except );
+      if( subjective_failure_tracker::is_chargeable( *trace ) )
+         tracker.record_failure( { N(victim), N(failer) }, fc::microseconds( 1000 ), now );
+   }
+
+   signed_transaction make_trx( tester& chain, account_name signer, action_name act = N(fail) ) {
+      signed_transaction trx;
+      trx.actions.emplace_back( vector<permission_level>{{N(victim), config::active_name}}, N(failer), act, bytes() );
+      chain.set_transaction_headers( trx );
+      trx.sign( chain.get_private_key( signer, "active" ), chain.control->get_chain_id() );
+      return trx;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(subjective_failure_tests)
+
+BOOST_AUTO_TEST_CASE( decay_and_prune ) try {
+   subjective_failure_tracker tracker;
+   tracker.set_half_life( fc::seconds( 1 ) );
+   const subjective_failure_tracker::key_type key{ N(alice), N(contract) };
+   const fc::time_point start = fc::time_point::now();
+
+   tracker.record_failure( key, fc::microseconds( 1000 ), start );
+   tracker.record_failure( key, fc::microseconds( 1000 ), start );
+   BOOST_CHECK_EQUAL( tracker.wasted_us( key, start ), 2000 );
+   BOOST_CHECK_CLOSE( tracker.wasted_us( key, start + fc::seconds( 1 ) ), 1000, 0.01 );
+   BOOST_CHECK_EQUAL( tracker.get_entries().at( key ).failures, 2u );
+   BOOST_CHECK_EQUAL( tracker.wasted_us( { N(bob), N(contract) }, start ), 0 );
+
+   tracker.prune( start + fc::seconds( 5 ) );
+   BOOST_CHECK_EQUAL( tracker.get_entries().size(), 1u );
+   tracker.prune( start + fc::seconds( 20 ) );
+   BOOST_CHECK( tracker.get_entries().empty() );
+} FC_LOG_AND_RETHROW()
+
+// transactions naming victim@active that victim did not sign must not get victim's own transactions rejected
+BOOST_AUTO_TEST_CASE( spoofed_authorizer_is_not_charged ) try {
+   tester chain;
+   chain.create_accounts( {N(victim), N(attacker), N(failer)} );
+   chain.set_code( N(failer), failer_wast );
+   chain.produce_block();
+
+   subjective_failure_tracker tracker;
+   const subjective_failure_tracker::key_type key{ N(victim), N(failer) };
+   const fc::time_point now = fc::time_point::now();
+
+   for( int i = 0; i < 10; ++i ) {
+      auto trx = make_trx( chain, N(attacker) );
+      trx.actions.front().data = fc::raw::pack( i ); // distinct ids
+      trx.signatures.clear();
+      trx.sign( chain.get_private_key( N(attacker), "active" ), chain.control->get_chain_id() );
+      auto trace = chain.push_transaction( trx, fc::time_point::maximum(), 0, true );
+      BOOST_CHECK( trace->action_traces.empty() );
+      charge( tracker, trace, now );
+   }
+
+   auto expired = make_trx( chain, N(victim) );
+   expired.expiration = chain.control->head_block_time() - fc::seconds( 1 );
+   expired.signatures.clear();
+   expired.sign( chain.get_private_key( N(victim), "active" ), chain.control->get_chain_id() );
+   charge( tracker, chain.push_transaction( expired, fc::time_point::maximum(), 0, true ), now );
+
+   BOOST_CHECK_EQUAL( tracker.wasted_us( key, now ), 0 );
+
+   // a failure of a transaction victim did sign is charged
+   auto signed_by_victim = make_trx( chain, N(victim) );
+   auto trace = chain.push_transaction( signed_by_victim, fc::time_point::maximum(), 0, true );
+   BOOST_CHECK( !trace->action_traces.empty() );
+   charge( tracker, trace, now );
+   BOOST_CHECK_EQUAL( tracker.wasted_us( key, now ), 1000 );
+
+   // resubmitting a transaction that went through is a duplicate, not a failure
+   auto passed = make_trx( chain, N(victim), N(pass) );
+   BOOST_REQUIRE( !chain.push_transaction( passed, fc::time_point::maximum(), 0, true )->except );
+   charge( tracker, chain.push_transaction( passed, fc::time_point::maximum(), 0, true ), now );
+   BOOST_CHECK_EQUAL( tracker.wasted_us( key, now ), 1000 );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
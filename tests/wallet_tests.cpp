@@ -175,6 +175,23 @@ BOOST_AUTO_TEST_CASE(wallet_manager_test)
    BOOST_CHECK(find(pks.cbegin(), pks.cend(), pkey1.get_public_key()) != pks.cend());
    BOOST_CHECK(find(pks.cbegin(), pks.cend(), pkey2.get_public_key()) != pks.cend());
 
+   for (uint16_t threads : {0, 2}) {
+      wm.set_signing_threads(threads);
+      std::vector<chain::signed_transaction> trxs(5);
+      for (size_t i = 0; i < trxs.size(); ++i)
+         trxs[i].ref_block_num = i;
+      trxs = wm.sign_transactions(trxs, pubkeys, chain_id);
+      BOOST_REQUIRE_EQUAL(5u, trxs.size());
+      for (size_t i = 0; i < trxs.size(); ++i) {
+         BOOST_CHECK_EQUAL(i, trxs[i].ref_block_num);
+         flat_set<public_key_type> batch_pks;
+         trxs[i].get_signature_keys(chain_id, fc::time_point::maximum(), batch_pks);
+         BOOST_CHECK(batch_pks == pubkeys);
+      }
+   }
+   flat_set<public_key_type> unknown_keys{private_key_type::generate().get_public_key()};
+   BOOST_CHECK_THROW(wm.sign_transactions({trx}, unknown_keys, chain_id), wallet_missing_pub_key_exception);
+
    BOOST_CHECK_EQUAL(3u, wm.get_public_keys().size());
    wm.set_timeout(chrono::seconds(0));
    BOOST_CHECK_THROW(wm.get_public_keys(), wallet_locked_exception);
@@ -37,6 +37,10 @@ fc::variant verify_byte_round_trip_conversion( const abi_serializer& abis, const
 
    std::string r = fc::json::to_string(var2, fc::time_point::now() + max_serialization_time);
 
+   std::string json;
+   abis.binary_to_json(type, bytes, json, abi_serializer::create_yield_function( max_serialization_time ));
+   BOOST_TEST( json == r );
+
    auto bytes2 = abis.variant_to_binary(type, var2, abi_serializer::create_yield_function( max_serialization_time ));
 
    BOOST_TEST( fc::to_hex(bytes) == fc::to_hex(bytes2) );
@@ -51,6 +55,9 @@ void verify_round_trip_conversion( const abi_serializer& abis, const type_name&
    BOOST_REQUIRE_EQUAL(fc::to_hex(bytes), hex);
    auto var2 = abis.binary_to_variant(type, bytes, abi_serializer::create_yield_function( max_serialization_time ));
    BOOST_REQUIRE_EQUAL(fc::json::to_string(var2, fc::time_point::now() + max_serialization_time), expected_json);
+   std::string json;
+   abis.binary_to_json(type, bytes, json, abi_serializer::create_yield_function( max_serialization_time ));
+   BOOST_REQUIRE_EQUAL(json, expected_json);
    auto bytes2 = abis.variant_to_binary(type, var2, abi_serializer::create_yield_function( max_serialization_time ));
    BOOST_REQUIRE_EQUAL(fc::to_hex(bytes2), hex);
 }
@@ -2351,6 +2358,87 @@ BOOST_AUTO_TEST_CASE(variant_of_aliases)
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE(binary_to_json)
+{
+   auto abi = R"({
+      "version": "eosio::abi/1.1",
+      "structs": [
+         {"name": "base", "base": "", "fields": [
+            {"name": "owner", "type": "name"},
+         ]},
+         {"name": "row", "base": "base", "fields": [
+            {"name": "flags", "type": "bool[]"},
+            {"name": "small", "type": "int16?"},
+            {"name": "big", "type": "uint64"},
+            {"name": "who", "type": "name[]"},
+            {"name": "memo", "type": "string"},
+            {"name": "nested", "type": "base?"},
+         ]}
+      ],
+   })";
+
+   try {
+      abi_serializer abis(fc::json::from_string(abi).as<abi_def>(), abi_serializer::create_yield_function( max_serialization_time ));
+
+      verify_round_trip_conversion(abis, "row",
+         R"({"owner":"alice","flags":[1,0],"small":null,"big":"18446744073709551615","who":["bob","carol"],"memo":"a \"quoted\" memo","nested":{"owner":"dave"}})",
+         "0000000000855c3402010000ffffffffffffffff020000000000000e3d000000008048af410f6120227175"
+         "6f74656422206d656d6f010000000000a0b649" );
+
+      // appends to whatever is already in the buffer
+      auto bytes = abis.variant_to_binary("base", fc::json::from_string(R"({"owner":"alice"})"), abi_serializer::create_yield_function( max_serialization_time ));
+      std::string out = "[";
+      abis.binary_to_json("base", bytes, out, abi_serializer::create_yield_function( max_serialization_time ));
+      out += ",";
+      abis.binary_to_json("base", bytes, out, abi_serializer::create_yield_function( max_serialization_time ));
+      out += "]";
+      BOOST_CHECK_EQUAL(out, R"([{"owner":"alice"},{"owner":"alice"}])");
+
+      // truncated input is rejected the same way binary_to_variant rejects it
+      bytes.resize(4);
+      out.clear();
+      BOOST_CHECK_THROW( abis.binary_to_json("base", bytes, out, abi_serializer::create_yield_function( max_serialization_time )), unpack_exception );
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE(binary_to_json_repeated_field)
+{
+   auto abi = R"({
+      "version": "eosio::abi/1.1",
+      "structs": [
+         {"name": "base", "base": "", "fields": [
+            {"name": "owner", "type": "name"},
+            {"name": "count", "type": "uint32"},
+         ]},
+         {"name": "row", "base": "base", "fields": [
+            {"name": "owner", "type": "name"},
+         ]},
+         {"name": "outer", "base": "", "fields": [
+            {"name": "rows", "type": "row[]"},
+         ]}
+      ],
+   })";
+
+   try {
+      abi_serializer abis(fc::json::from_string(abi).as<abi_def>(), abi_serializer::create_yield_function( max_serialization_time ));
+
+      verify_round_trip_conversion(abis, "row", R"({"owner":"bob","count":7})",
+         "0000000000000e3d070000000000000000000e3d" );
+
+      // the repeated key is written once, where binary_to_variant first put it, holding the derived value
+      auto check = [&]( const type_name& type, const char* hex, const std::string& expected ) {
+         bytes packed = fc::variant( hex ).as<bytes>();
+         std::string out;
+         abis.binary_to_json(type, packed, out, abi_serializer::create_yield_function( max_serialization_time ));
+         BOOST_CHECK_EQUAL(out, expected);
+         BOOST_CHECK_EQUAL(out, fc::json::to_string(abis.binary_to_variant(type, packed, abi_serializer::create_yield_function( max_serialization_time )),
+                                                    fc::time_point::maximum()));
+      };
+      check("row", "0000000000855c34070000000000000000000e3d", R"({"owner":"bob","count":7})");
+      check("outer", "010000000000855c34070000000000000000000e3d", R"({"rows":[{"owner":"bob","count":7}]})");
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE(extend)
 {
    using eosio::testing::fc_exception_message_starts_with;
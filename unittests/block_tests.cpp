@@ -193,6 +193,39 @@ BOOST_AUTO_TEST_CASE(broadcasted_block_test)
   BOOST_CHECK(std::equal(bcasted_blk_by_prod_node_packed.begin(), bcasted_blk_by_prod_node_packed.end(), bcasted_blk_by_recv_node_packed.begin()));
 }
 
+/**
+ * Ensure that a run of blocks can be validated ahead of being pushed, each against the one before it
+ */
+BOOST_AUTO_TEST_CASE(pipelined_block_validation_test)
+{
+  tester producer_node;
+  producer_node.create_accounts( {N(alice), N(bob)} );
+  producer_node.produce_blocks(3);
+
+  tester receiving_node(setup_policy::none);
+
+  vector<signed_block_ptr> blocks;
+  for( uint32_t n = receiving_node.control->head_block_num() + 1; n <= producer_node.control->head_block_num(); ++n )
+    blocks.push_back( producer_node.control->fetch_block_by_number( n ) );
+  BOOST_REQUIRE( blocks.size() > 2 );
+
+  // none of these are in the fork database yet, all but the first build on a block that is still pending
+  vector<std::future<block_state_ptr>> futures;
+  for( const auto& b : blocks )
+    futures.emplace_back( receiving_node.control->create_block_state_future( b ) );
+
+  // a block that builds on neither the fork database nor a pending block is unlinkable
+  auto orphan = std::make_shared<signed_block>( *blocks.back() );
+  orphan->previous = fc::sha256::hash( std::string("orphan") );
+  BOOST_REQUIRE_THROW( receiving_node.control->create_block_state_future( orphan ), unlinkable_block_exception );
+
+  for( const auto& b : blocks )
+    receiving_node.push_block( b );
+
+  BOOST_REQUIRE_EQUAL( receiving_node.control->head_block_id(), producer_node.control->head_block_id() );
+  BOOST_REQUIRE_EQUAL( futures.back().get()->id, blocks.back()->id() );
+}
+
 /**
  * Verify abort block returns applied transactions in block
  */
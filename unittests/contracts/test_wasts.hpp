@@ -675,6 +675,55 @@ static const char memory_growth_memset_test[] = R"=====(
 )
 )=====";
 
+static const char memory_shrink_store[] = R"=====(
+(module
+ (export "apply" (func $apply))
+ (memory $0 1)
+ (func $apply (param $0 i64)(param $1 i64)(param $2 i64)
+    (drop (grow_memory (i32.const 2)))
+    (i32.store (i32.const 80000) (i32.const 2))
+    (i32.store (i32.const 140000) (i32.const 3))
+    (drop (grow_memory (i32.const -2)))
+ )
+)
+)=====";
+
+static const char memory_shrink_test[] = R"=====(
+(module
+ (export "apply" (func $apply))
+ (import "env" "eosio_assert" (func $eosio_assert (param i32 i32)))
+ (memory $0 3)
+ (func $apply (param $0 i64)(param $1 i64)(param $2 i64)
+   (call $eosio_assert
+     (i32.eq
+       (i32.load offset=80000 (i32.const 0))
+       (i32.const 0)
+     )
+     (i32.const 0)
+   )
+   (call $eosio_assert
+     (i32.eq
+       (i32.load offset=140000 (i32.const 0))
+       (i32.const 0)
+     )
+     (i32.const 0)
+   )
+ )
+)
+)=====";
+
+static const char table_reader_wast[] = R"=====(
+(module
+ (export "apply" (func $apply))
+ (import "env" "db_lowerbound_i64" (func $db_lowerbound_i64 (param i64 i64 i64 i64) (result i32)))
+ (memory $0 1)
+ (func $apply (param $0 i64)(param $1 i64)(param $2 i64)
+   (drop (call $db_lowerbound_i64 (get_local $0) (i64.const 0) (i64.const 0) (i64.const 0)))
+   (drop (call $db_lowerbound_i64 (i64.const 6138663577826885632) (i64.const 0) (i64.const 0) (i64.const 0)))
+ )
+)
+)=====";
+
 static const char large_maligned_host_ptr[] = R"=====(
 (module
  (export "apply" (func $$apply))
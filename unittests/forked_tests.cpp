@@ -778,4 +778,60 @@ BOOST_AUTO_TEST_CASE( push_block_returns_forked_transactions ) try {
 } FC_LOG_AND_RETHROW()
 
 
+BOOST_AUTO_TEST_CASE( fork_database_journal ) try {
+   tester c;
+   vector<block_state_ptr> states;
+   auto conn = c.control->accepted_block.connect( [&]( const block_state_ptr& bsp ) {
+      states.push_back( std::make_shared<block_state>( *bsp ) );
+   } );
+   c.produce_blocks(6);
+   conn.disconnect();
+   BOOST_REQUIRE_EQUAL( states.size(), 6u );
+
+   auto noop = []( block_timestamp_type, const flat_set<digest_type>&, const vector<digest_type>& ) {};
+
+   fc::temp_directory tempdir;
+   {
+      fork_database fdb( tempdir.path() );
+      fdb.open( noop );
+      BOOST_REQUIRE( !fdb.head() );
+
+      fdb.reset( *states[0] );
+      for( size_t i = 1; i < states.size(); ++i )
+         fdb.add( states[i] );
+      BOOST_REQUIRE_EQUAL( fdb.head()->id, states[5]->id );
+
+      fdb.advance_root( states[2]->id );
+      fdb.rollback_head_to_root();
+      fdb.mark_valid( fdb.get_block( states[3]->id ) );
+      fdb.remove( states[4]->id );
+      BOOST_REQUIRE_EQUAL( fdb.head()->id, states[3]->id );
+      // not closed, as if the node crashed
+   }
+
+   const auto journal = tempdir.path() / config::forkdb_journal_filename;
+   {
+      fork_database fdb( tempdir.path() );
+      fdb.open( noop );
+      BOOST_REQUIRE_EQUAL( fdb.root()->id, states[2]->id );
+      BOOST_REQUIRE_EQUAL( fdb.head()->id, states[3]->id );
+      BOOST_REQUIRE( !fdb.get_block( states[4]->id ) );
+      BOOST_REQUIRE( !fdb.get_block( states[1]->id ) );
+      fdb.close();
+   }
+
+   // a partially written record at the end is dropped on open
+   boost::filesystem::resize_file( journal, boost::filesystem::file_size( journal ) - 1 );
+   {
+      fork_database fdb( tempdir.path() );
+      fdb.open( noop );
+      BOOST_REQUIRE_EQUAL( fdb.root()->id, states[2]->id );
+      BOOST_REQUIRE_EQUAL( fdb.head()->id, states[3]->id );
+      BOOST_REQUIRE( fdb.get_block( states[4]->id ) );
+      BOOST_REQUIRE( fdb.get_block( states[5]->id ) );
+   }
+
+} FC_LOG_AND_RETHROW()
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 #include <eosio/chain/chain_config.hpp>
 #include <eosio/chain/types.hpp>
 #include <eosio/chain/thread_utils.hpp>
+#include <eosio/chain/merkle.hpp>
 #include <eosio/testing/tester.hpp>
 
 #include <fc/io/json.hpp>
@@ -1178,6 +1179,25 @@ BOOST_AUTO_TEST_CASE(bad_alloc_test) {
    BOOST_CHECK( ptr == nullptr );
 }
 
+BOOST_AUTO_TEST_CASE(merkle_accumulator_test) { try {
+   vector<digest_type> leaves;
+   merkle_accumulator acc;
+   BOOST_CHECK_EQUAL( acc.get_root(), merkle( leaves ) );
+   for( uint32_t i = 0; i < 70; ++i ) {
+      leaves.emplace_back( digest_type::hash( i ) );
+      acc.append( leaves.back() );
+      BOOST_CHECK_EQUAL( acc.size(), leaves.size() );
+      BOOST_CHECK_EQUAL( acc.get_root(), merkle( leaves ) );
+   }
+
+   // a copy serves as a restore point
+   merkle_accumulator restore = acc;
+   acc.append( digest_type::hash( 1000 ) );
+   BOOST_CHECK( acc.get_root() != merkle( leaves ) );
+   acc = restore;
+   BOOST_CHECK_EQUAL( acc.get_root(), merkle( leaves ) );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace eosio
@@ -2,9 +2,11 @@
 
 #include <eosio/chain/block_log.hpp>
 #include <eosio/chain/global_property_object.hpp>
+#include <eosio/chain/reversible_block_log.hpp>
 #include <eosio/chain/snapshot.hpp>
 #include <eosio/testing/tester.hpp>
 
+#include <boost/filesystem.hpp>
 #include <boost/mpl/list.hpp>
 #include <boost/test/unit_test.hpp>
 
@@ -78,4 +80,65 @@ BOOST_AUTO_TEST_CASE(test_restart_with_different_chain_id)
    BOOST_REQUIRE_EXCEPTION(other.open(chain_id), chain_id_type_exception, fc_exception_message_starts_with("chain ID in state "));
 }
 
+BOOST_AUTO_TEST_CASE(test_reversible_block_log)
+{
+   tester chain;
+   std::vector<signed_block_ptr> blocks;
+   for (int i = 0; i < 6; ++i)
+      blocks.push_back(chain.produce_block());
+   const auto first = blocks.front()->block_num();
+
+   fc::temp_directory tempdir;
+   const auto dir = tempdir.path() / config::reversible_blocks_dir_name;
+   {
+      reversible_block_log log(dir);
+      BOOST_REQUIRE(log.empty());
+      for (auto& b : blocks)
+         log.append(b);
+      BOOST_REQUIRE_THROW(log.append(blocks[2]), reversible_blocks_exception);
+      BOOST_REQUIRE_EQUAL(log.first_block_num(), first);
+      BOOST_REQUIRE_EQUAL(log.last_block_num(), first + 5);
+      BOOST_REQUIRE_EQUAL(log.read_block(first + 3)->id(), blocks[3]->id());
+      BOOST_REQUIRE(*log.read_block_id(first + 4) == blocks[4]->id());
+      BOOST_REQUIRE(!log.read_block(first + 6));
+
+      log.remove_from(first + 5); // pop the head
+      BOOST_REQUIRE_EQUAL(log.last_block_num(), first + 4);
+      log.remove_through(first + 3); // irreversible, compacts the file
+      BOOST_REQUIRE_EQUAL(log.first_block_num(), first + 4);
+      BOOST_REQUIRE_EQUAL(log.read_block(first + 4)->id(), blocks[4]->id());
+      log.append(blocks[5]);
+   }
+
+   // a partially written block at the end is dropped on open
+   const auto file = dir / reversible_block_log::file_name;
+   boost::filesystem::resize_file(file, boost::filesystem::file_size(file) - 1);
+   {
+      // unless opened read only, as tools do while a node may still be appending
+      const auto size = boost::filesystem::file_size(file);
+      reversible_block_log log(dir, reversible_block_log::open_mode::read_only);
+      BOOST_REQUIRE_EQUAL(log.last_block_num(), first + 4);
+      BOOST_REQUIRE_EQUAL(log.read_block(first + 4)->id(), blocks[4]->id());
+      BOOST_REQUIRE_THROW(log.append(blocks[5]), reversible_blocks_exception);
+      BOOST_REQUIRE_EQUAL(boost::filesystem::file_size(file), size);
+   }
+   {
+      reversible_block_log log(dir);
+      BOOST_REQUIRE_EQUAL(log.first_block_num(), first + 4);
+      BOOST_REQUIRE_EQUAL(log.last_block_num(), first + 4);
+      BOOST_REQUIRE_EQUAL(log.read_block(first + 4)->id(), blocks[4]->id());
+      log.append(blocks[5]);
+      log.remove_through(first + 5);
+      BOOST_REQUIRE(log.empty());
+   }
+
+   // read only does not create anything
+   const auto missing = tempdir.path() / "missing";
+   {
+      reversible_block_log log(missing, reversible_block_log::open_mode::read_only);
+      BOOST_REQUIRE(log.empty());
+   }
+   BOOST_REQUIRE(!fc::exists(missing));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -306,5 +306,92 @@ BOOST_AUTO_TEST_CASE( unapplied_transaction_queue_test ) try {
 
 } FC_LOG_AND_RETHROW() /// unapplied_transaction_queue_test
 
+BOOST_AUTO_TEST_CASE( unapplied_transaction_footprint_test ) try {
+
+   unapplied_transaction_queue q;
+
+   auto trx1 = unique_trx_meta_data();
+   auto trx2 = unique_trx_meta_data();
+
+   q.add_persisted( trx1, { N(alice), N(eosio.token) } );
+   q.add_persisted( trx2 );
+   BOOST_REQUIRE( q.size() == 2 );
+
+   auto find = [&]( const transaction_metadata_ptr& trx ) {
+      for( auto itr = q.persisted_begin(); itr != q.persisted_end(); ++itr ) {
+         if( itr->trx_meta == trx ) return itr;
+      }
+      BOOST_FAIL( "trx not in queue" );
+      return q.persisted_end();
+   };
+
+   BOOST_CHECK( find( trx1 )->untouched_by( {} ) );
+   BOOST_CHECK( find( trx1 )->untouched_by( { N(bob), N(carol) } ) );
+   BOOST_CHECK( !find( trx1 )->untouched_by( { N(bob), N(eosio.token) } ) );
+   BOOST_CHECK( !find( trx1 )->untouched_by( { N(alice) } ) );
+
+   // unknown footprint is always considered touched
+   BOOST_CHECK( !find( trx2 )->untouched_by( {} ) );
+   BOOST_CHECK( !find( trx2 )->untouched_by( { N(bob) } ) );
+
+   // persisting again replaces the footprint
+   q.add_persisted( trx1, { N(bob) } );
+   BOOST_CHECK( q.size() == 2 );
+   BOOST_CHECK( find( trx1 )->untouched_by( { N(alice), N(eosio.token) } ) );
+   BOOST_CHECK( !find( trx1 )->untouched_by( { N(bob) } ) );
+
+} FC_LOG_AND_RETHROW() /// unapplied_transaction_footprint_test
+
+BOOST_AUTO_TEST_CASE( unapplied_transaction_priority_test ) try {
+
+   unapplied_transaction_queue q;
+   q.set_priority_function( []( const transaction_metadata_ptr& trx ) -> int64_t {
+      return -int64_t( trx->billed_cpu_time_us );
+   } );
+
+   auto trx1 = unique_trx_meta_data();
+   auto trx2 = unique_trx_meta_data();
+   auto trx3 = unique_trx_meta_data();
+   auto trx4 = unique_trx_meta_data();
+   auto trx5 = unique_trx_meta_data();
+   trx1->billed_cpu_time_us = 300;
+   trx2->billed_cpu_time_us = 100;
+   trx3->billed_cpu_time_us = 200;
+   trx4->billed_cpu_time_us = 100;
+   trx5->billed_cpu_time_us = 500;
+
+   q.add_aborted( { trx1, trx2, trx3, trx4 } );
+   q.add_persisted( trx5 );
+   BOOST_CHECK( q.size() == 5 );
+
+   // persisted still come first, then cheapest first with ties in insertion order
+   BOOST_REQUIRE( next( q ) == trx5 );
+   BOOST_REQUIRE( next( q ) == trx2 );
+   BOOST_REQUIRE( next( q ) == trx4 );
+   BOOST_REQUIRE( next( q ) == trx3 );
+   BOOST_REQUIRE( next( q ) == trx1 );
+   BOOST_REQUIRE( next( q ) == nullptr );
+
+   // persisted transactions are not reordered by priority, an aborted one that becomes persisted goes last
+   q.add_persisted( trx1 );
+   q.add_persisted( trx2 );
+   q.add_aborted( { trx3, trx4 } );
+   q.add_persisted( trx4 );
+   BOOST_CHECK( q.size() == 4 );
+   BOOST_REQUIRE( next( q ) == trx1 );
+   BOOST_REQUIRE( next( q ) == trx2 );
+   BOOST_REQUIRE( next( q ) == trx4 );
+   BOOST_REQUIRE( next( q ) == trx3 );
+   BOOST_REQUIRE( next( q ) == nullptr );
+
+   // nor are forked transactions, they stay in block order
+   q.add_forked( { create_test_block_state( { trx1, trx2, trx3 } ) } );
+   BOOST_REQUIRE( next( q ) == trx1 );
+   BOOST_REQUIRE( next( q ) == trx2 );
+   BOOST_REQUIRE( next( q ) == trx3 );
+   BOOST_REQUIRE( next( q ) == nullptr );
+
+} FC_LOG_AND_RETHROW() /// unapplied_transaction_priority_test
+
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,9 @@
 #include <eosio/chain/wasm_eosio_constraints.hpp>
 #include <eosio/chain/wast_to_wasm.hpp>
 #include <eosio/testing/tester.hpp>
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+#include <eosio/chain/webassembly/eos-vm-oc/memory.hpp>
+#endif
 
 #include <Inline/Serialization.h>
 #include <IR/Module.h>
@@ -1577,6 +1580,94 @@ BOOST_FIXTURE_TEST_CASE( mem_growth_memset, TESTER ) try {
    }
 } FC_LOG_AND_RETHROW()
 
+// memory written before a module shrinks its memory must still be cleared for the next action
+BOOST_FIXTURE_TEST_CASE( mem_shrink_memset, TESTER ) try {
+   produce_blocks(2);
+
+   create_accounts( {N(grower)} );
+   produce_block();
+
+   action act;
+   act.account = N(grower);
+   act.name = N();
+   act.authorization = vector<permission_level>{{N(grower),config::active_name}};
+
+   set_code(N(grower), memory_shrink_store);
+   {
+      signed_transaction trx;
+      trx.actions.push_back(act);
+      set_transaction_headers(trx);
+      trx.sign(get_private_key( N(grower), "active" ), control->get_chain_id());
+      push_transaction(trx);
+   }
+
+   produce_blocks(1);
+   set_code(N(grower), memory_shrink_test);
+   {
+      signed_transaction trx;
+      trx.actions.push_back(act);
+      set_transaction_headers(trx);
+      trx.sign(get_private_key( N(grower), "active" ), control->get_chain_id());
+      push_transaction(trx);
+   }
+} FC_LOG_AND_RETHROW()
+
+// table lookups outside the receiver are recorded for the reapply-touched-trxs-only footprint
+BOOST_FIXTURE_TEST_CASE( table_codes_read, TESTER ) try {
+   produce_blocks(2);
+
+   create_accounts( {N(reader)} );
+   produce_block();
+
+   set_code(N(reader), table_reader_wast);
+   produce_block();
+
+   action act;
+   act.account = N(reader);
+   act.name = N();
+   act.authorization = vector<permission_level>{{N(reader),config::active_name}};
+
+   signed_transaction trx;
+   trx.actions.push_back(act);
+   set_transaction_headers(trx);
+   trx.sign(get_private_key( N(reader), "active" ), control->get_chain_id());
+   auto trace = push_transaction(trx);
+
+   BOOST_CHECK( trace->table_codes_read == flat_set<account_name>{ config::system_account_name } );
+} FC_LOG_AND_RETHROW()
+
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+// the range an EOS VM OC reset clears follows the pages the previous execution used, not the largest ever used
+BOOST_AUTO_TEST_CASE( eosvmoc_reset_clears_previous_execution ) try {
+   constexpr uint64_t page = 64u*1024u;
+   eosvmoc::memory mem;
+   auto all_zero = [&](uint64_t pages) {
+      const uint8_t* p = mem.full_page_memory_base();
+      return std::all_of(p, p + pages*page, [](uint8_t b) { return b == 0; });
+   };
+
+   mem.reset_linear_memory();
+   BOOST_CHECK_EQUAL(mem.dirty_linear_memory_pages(), 0u);
+
+   // a large execution
+   memset(mem.full_page_memory_base(), 0xff, 10*page);
+   mem.mark_linear_memory_dirty(10);
+   BOOST_CHECK_EQUAL(mem.dirty_linear_memory_pages(), 10u);
+
+   // followed by a small one, everything the large one wrote is cleared
+   mem.reset_linear_memory();
+   BOOST_CHECK(all_zero(10));
+   memset(mem.full_page_memory_base(), 0xff, page);
+   mem.mark_linear_memory_dirty(1);
+   BOOST_CHECK_EQUAL(mem.dirty_linear_memory_pages(), 1u);
+
+   // so the next reset only clears the page the small one used
+   mem.reset_linear_memory();
+   BOOST_CHECK_EQUAL(mem.dirty_linear_memory_pages(), 0u);
+   BOOST_CHECK(all_zero(10));
+} FC_LOG_AND_RETHROW()
+#endif
+
 INCBIN(fuzz1, "fuzz1.wasm");
 INCBIN(fuzz2, "fuzz2.wasm");
 INCBIN(fuzz3, "fuzz3.wasm");